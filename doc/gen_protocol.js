@@ -0,0 +1,146 @@
+//
+// CDJ3K SUBUCOM protocol header generator
+//
+// Writes src/lib/protocol.h from subucom_fields.js:
+//
+//   node doc/gen_protocol.js > src/lib/protocol.h
+//
+// or "make protocol-header". The header is committed, node is only needed
+// when the fields change.
+//
+// This file is part of the Magic Phono project (https://magicphono.org/).
+//Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+//
+
+const fields = require('./subucom_fields');
+
+const FRAME_BITS = 62 * 8;
+const SUPERSCRIPTS = '¹²³⁴⁵⁶⁷⁸⁹';
+
+function hex(value, digits) {
+    return '0x' + value.toString(16).toUpperCase().padStart(digits, '0');
+}
+
+// "HOTCUE_A (R)⁴" -> { name: "HOTCUE_A_R", note: 4 }
+function parse_name(name) {
+    let note = 0;
+    for (const ch of name) {
+        const i = SUPERSCRIPTS.indexOf(ch);
+        if (i >= 0) {
+            note = i + 1;
+        }
+    }
+
+    const clean = name
+        .replace(/[¹²³⁴⁵⁶⁷⁸⁹?]/g, '')
+        .replace(/ \((.)\)/, '_$1')
+        .replace(/^SUBUCOM_/, '')
+        .trim();
+
+    return { name: clean, note: note };
+}
+
+// bit positions of every named field, LSB first within each byte
+function layout(reg, what) {
+    const out = [];
+    let pos = 0;
+
+    for (const field of reg) {
+        if (field.name !== undefined && field.name !== 'TBD?') {
+            const { name, note } = parse_name(field.name);
+            const width = field.bits;
+
+            if (width > 8 && (pos % 8 !== 0 || width % 8 !== 0)) {
+                throw new Error(`${what} ${name}: multi-byte fields must be byte aligned`);
+            }
+            if (width <= 8 && Math.floor(pos / 8) !== Math.floor((pos + width - 1) / 8)) {
+                throw new Error(`${what} ${name}: field crosses a byte boundary`);
+            }
+            if (out.some(f => f.name === name)) {
+                throw new Error(`${what} ${name}: duplicate field`);
+            }
+
+            out.push({ name, note, byte: Math.floor(pos / 8), shift: pos % 8, width });
+        }
+        pos += field.bits;
+    }
+
+    if (pos > FRAME_BITS) {
+        throw new Error(`${what}: ${pos} bits do not fit in front of the CRC`);
+    }
+
+    return out;
+}
+
+function defines(prefix, list) {
+    const lines = [];
+    for (const f of list) {
+        const mask = (f.width <= 8) ? (((1 << f.width) - 1) << f.shift) : (2 ** f.width - 1);
+        const p = `${prefix}_${f.name}`;
+        lines.push(`#define ${(p + '_BYTE').padEnd(40)} ${hex(f.byte, 2)}`);
+        lines.push(`#define ${(p + '_SHIFT').padEnd(40)} ${f.shift}`);
+        lines.push(`#define ${(p + '_WIDTH').padEnd(40)} ${f.width}`);
+        lines.push(`#define ${(p + '_MASK').padEnd(40)} ${hex(mask, f.width <= 8 ? 2 : 4)}`);
+    }
+    return lines.join('\n');
+}
+
+function xmacro(macro, list) {
+    const rows = list.map(f => `    X(${f.name}, ${hex(f.byte, 2)}, ${f.shift}, ${f.width})`);
+    return `#define ${macro}(X) \\\n` + rows.join(' \\\n') + '\n';
+}
+
+// single bit input fields sharing a note are exclusive with one another
+function groups(list) {
+    const lines = [];
+    const notes = [...new Set(list.filter(f => f.note > 0).map(f => f.note))].sort();
+    for (const note of notes) {
+        const members = list.filter(f => f.note === note);
+        const byte = members[0].byte;
+        if (members.some(f => f.byte !== byte || f.width !== 1)) {
+            throw new Error(`input group ${note}: members must be single bits of one byte`);
+        }
+        const mask = members.reduce((m, f) => m | (1 << f.shift), 0);
+        lines.push(`/* ${members.map(f => f.name).join(', ')} */`);
+        lines.push(`#define ${('SUBUCOM_IN_GROUP' + note + '_BYTE').padEnd(40)} ${hex(byte, 2)}`);
+        lines.push(`#define ${('SUBUCOM_IN_GROUP' + note + '_MASK').padEnd(40)} ${hex(mask, 2)}`);
+    }
+    return lines.join('\n');
+}
+
+const input = layout(fields.input, 'input');
+const output = layout(fields.output, 'output');
+
+process.stdout.write(`// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom protocol fields
+ *
+ *  Generated by doc/gen_protocol.js from doc/subucom_fields.js, do not edit.
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __PROTOCOL_H_
+#define __PROTOCOL_H_
+
+/*
+ * Every field has _BYTE (first byte, multi-byte fields are big endian),
+ * _SHIFT and _WIDTH in bits, and _MASK (within its byte for fields of up
+ * to 8 bits).
+ */
+
+/* input frame */
+${defines('SUBUCOM_IN', input)}
+
+/* input keys exclusive with one another */
+${groups(input)}
+
+/* output frame */
+${defines('SUBUCOM_OUT', output)}
+
+/* X(name, byte, shift, width) for every field, to build tables from */
+${xmacro('SUBUCOM_IN_FIELDS', input)}
+${xmacro('SUBUCOM_OUT_FIELDS', output)}
+#endif /* __PROTOCOL_H_ */
+`);
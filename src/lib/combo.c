@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom key combo detection
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "combo.h"
+#include "protocol.h"
+
+/* every 1 bit field in the button bytes, byte 5 in the low 8 bits */
+#define BUTTON_BIT(name, byte, shift, width) \
+    | (((width) == 1 && (byte) >= SUBUCOM_IN_PLAY_BYTE && (byte) < SUBUCOM_IN_PLAY_BYTE + 8) \
+       ? 1ull << (((byte) - SUBUCOM_IN_PLAY_BYTE) * 8 + (shift)) : 0)
+
+static const uint64_t button_bits = 0 SUBUCOM_IN_FIELDS(BUTTON_BIT);
+
+static void set_mask_byte(uint64_t* words, uint8_t byte, uint8_t bits) {
+    uint8_t* bytes = (uint8_t *)words;
+    bytes[byte] |= bits;
+}
+
+static void load_frame(uint64_t* words, const uint8_t* buf, uint8_t lo, uint8_t hi) {
+    memcpy(&words[lo], buf + lo * sizeof(uint64_t), (hi - lo + 1) * sizeof(uint64_t));
+}
+
+void combo_set_init(combo_set_t* combos) {
+    memset(combos, 0, sizeof(combo_set_t));
+    combos->_word_lo = COMBO_WORDS - 1;
+}
+
+int combo_add(combo_set_t* combos, int id, const combo_key_t* keys, uint8_t num_keys, bool exact, uint32_t hold_ms) {
+    if (combos->num_combos == COMBO_MAX) {
+        fprintf(stderr, "combo: Too many combos\n");
+        return -1;
+    }
+
+    uint8_t idx = combos->num_combos;
+    uint64_t* want = combos->want[idx];
+    uint64_t* care = combos->care[idx];
+
+    memset(want, 0, sizeof(combos->want[idx]));
+    memset(care, 0, sizeof(combos->care[idx]));
+
+    for (int i = 0; i < num_keys; i++) {
+        if (keys[i].byte >= COMBO_FRAME_SIZE - 2) {
+            fprintf(stderr, "combo: Invalid byte %d\n", keys[i].byte);
+            return -1;
+        }
+        set_mask_byte(want, keys[i].byte, keys[i].bit);
+        set_mask_byte(care, keys[i].byte, keys[i].bit);
+    }
+
+    if (exact) {
+        for (uint8_t i = 0; i < sizeof(button_bits); i++) {
+            set_mask_byte(care, SUBUCOM_IN_PLAY_BYTE + i, (uint8_t)(button_bits >> (i * 8)));
+        }
+    }
+
+    /* only evaluate the words some combo cares about */
+    for (uint8_t w = 0; w < COMBO_WORDS; w++) {
+        if (care[w] != 0) {
+            if (w < combos->_word_lo) {
+                combos->_word_lo = w;
+            }
+            if (w > combos->_word_hi) {
+                combos->_word_hi = w;
+            }
+        }
+    }
+
+    combos->ids[idx] = id;
+    combos->hold_ms[idx] = hold_ms;
+    combos->num_combos++;
+
+    return idx;
+}
+
+/* bitmask of the combos matching buf, without any hold tracking */
+uint32_t combo_matching(const combo_set_t* combos, const uint8_t* buf) {
+    uint64_t frame[COMBO_WORDS];
+    uint32_t matched = 0;
+
+    if (combos->num_combos == 0) {
+        return 0;
+    }
+
+    load_frame(frame, buf, combos->_word_lo, combos->_word_hi);
+
+    for (uint8_t i = 0; i < combos->num_combos; i++) {
+        uint64_t diff = 0;
+        for (uint8_t w = combos->_word_lo; w <= combos->_word_hi; w++) {
+            diff |= (frame[w] & combos->care[i][w]) ^ combos->want[i][w];
+        }
+        matched |= (uint32_t)(diff == 0) << i;
+    }
+
+    return matched;
+}
+
+/*
+ * Evaluate all combos against a new frame. Returns the bitmask of combos
+ * (by index) that fired: on the frame they start matching, or once they
+ * have matched for hold_ms. Each combo fires once per match.
+ */
+uint32_t combo_eval(combo_set_t* combos, const uint8_t* buf, int64_t now_ms) {
+    uint32_t matched = combo_matching(combos, buf);
+    uint32_t started = matched & ~combos->_matched;
+
+    combos->_matched = matched;
+    combos->_fired &= matched;
+
+    /* only combos that are matching and haven't fired need a look */
+    uint32_t pending = matched & ~combos->_fired;
+    uint32_t fired = 0;
+
+    while (pending != 0) {
+        int i = __builtin_ctz(pending);
+        pending &= pending - 1;
+
+        if (started & (1u << i)) {
+            combos->_since_ms[i] = now_ms;
+        }
+        if (now_ms - combos->_since_ms[i] >= combos->hold_ms[i]) {
+            fired |= 1u << i;
+        }
+    }
+
+    combos->_fired |= fired;
+
+    return fired;
+}
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom key combo detection
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __COMBO_H_
+#define __COMBO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define COMBO_MAX           32
+#define COMBO_FRAME_SIZE    64
+#define COMBO_WORDS         (COMBO_FRAME_SIZE / sizeof(uint64_t))
+
+/* one button of a combo, byte/bit as in button_def_t */
+typedef struct combo_key {
+    uint8_t byte;
+    uint8_t bit;
+} combo_key_t;
+
+/*
+ * A set of combos compiled into (want, care) bitmasks over the input frame.
+ * A combo matches when (frame & care) == want, which is evaluated for all
+ * combos with a few 64-bit operations per frame. "Exact" combos care about
+ * every button bit, so any extra button held breaks the match.
+ */
+typedef struct combo_set {
+    uint64_t want[COMBO_MAX][COMBO_WORDS];
+    uint64_t care[COMBO_MAX][COMBO_WORDS];
+    uint32_t hold_ms[COMBO_MAX];
+    int      ids[COMBO_MAX];
+    uint8_t  num_combos;
+
+    uint8_t  _word_lo;          /* words any combo looks at */
+    uint8_t  _word_hi;
+    uint32_t _matched;          /* combos matching the last frame */
+    uint32_t _fired;            /* combos fired during their current match */
+    int64_t  _since_ms[COMBO_MAX];
+} combo_set_t;
+
+void     combo_set_init(combo_set_t* combos);
+int      combo_add(combo_set_t* combos, int id, const combo_key_t* keys, uint8_t num_keys, bool exact, uint32_t hold_ms);
+uint32_t combo_eval(combo_set_t* combos, const uint8_t* buf, int64_t now_ms);
+uint32_t combo_matching(const combo_set_t* combos, const uint8_t* buf);
+
+#endif /* __COMBO_H_ */
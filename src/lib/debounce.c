@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom frame debouncing
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debounce.h"
+
+/* every 1 bit field in the button bytes */
+#define BUTTON_MASK(name, byte, shift, width) \
+    if ((width) == 1 && (byte) >= SUBUCOM_IN_PLAY_BYTE && (byte) < SUBUCOM_IN_PLAY_BYTE + 8) { \
+        masks[DEBOUNCE_BUTTONS][byte] |= 1 << (shift); \
+    }
+
+static const char* class_names[DEBOUNCE_NUM_CLASSES] = {
+    [DEBOUNCE_BUTTONS]     = "buttons",
+    [DEBOUNCE_SLIP_PADDLE] = "slip_paddle",
+    [DEBOUNCE_JOG_PRESS]   = "jog_press",
+};
+
+static void load_words(uint64_t* words, const uint8_t* bytes) {
+    memcpy(words, bytes, DEBOUNCE_FRAME_SIZE);
+}
+
+int debounce_init(debounce_t* debounce, const uint8_t frames[DEBOUNCE_NUM_CLASSES]) {
+    uint8_t masks[DEBOUNCE_NUM_CLASSES][DEBOUNCE_FRAME_SIZE] = { { 0 } };
+    uint8_t mask[DEBOUNCE_FRAME_SIZE] = { 0 };
+    uint8_t limit[3][DEBOUNCE_FRAME_SIZE] = { { 0 } };
+
+    SUBUCOM_IN_FIELDS(BUTTON_MASK)
+    masks[DEBOUNCE_SLIP_PADDLE][SUBUCOM_IN_SLIP_PADDLE_BYTE] = SUBUCOM_IN_SLIP_PADDLE_MASK;
+    masks[DEBOUNCE_JOG_PRESS][SUBUCOM_IN_JOG_PRESS_BYTE] = SUBUCOM_IN_JOG_PRESS_MASK;
+
+    memset(debounce, 0, sizeof(debounce_t));
+
+    for (int c = 0; c < DEBOUNCE_NUM_CLASSES; c++) {
+        if (frames[c] > DEBOUNCE_MAX_FRAMES) {
+            fprintf(stderr, "debounce: At most %d frames for %s\n", DEBOUNCE_MAX_FRAMES, class_names[c]);
+            return -1;
+        }
+        debounce->frames[c] = frames[c];
+        if (frames[c] <= 1) {
+            continue;
+        }
+
+        for (int i = 0; i < DEBOUNCE_FRAME_SIZE; i++) {
+            mask[i] |= masks[c][i];
+            for (int b = 0; b < 3; b++) {
+                if (frames[c] & (1 << b)) {
+                    limit[b][i] |= masks[c][i];
+                }
+            }
+        }
+        debounce->enabled = true;
+    }
+
+    load_words(debounce->_mask, mask);
+    for (int b = 0; b < 3; b++) {
+        load_words(debounce->_limit[b], limit[b]);
+    }
+
+    return 0;
+}
+
+/* parse e.g. "buttons=3,slip_paddle=2", classes not listed are left as they are */
+int debounce_parse(uint8_t frames[DEBOUNCE_NUM_CLASSES], const char* str) {
+    char buf[128];
+    strncpy(buf, str, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    char* save = NULL;
+    for (char* tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+        char* eq = strchr(tok, '=');
+        char* end = NULL;
+        long val = (eq != NULL) ? strtol(eq + 1, &end, 10) : -1;
+
+        if (eq == NULL || end == eq + 1 || *end != '\0' || val < 0 || val > DEBOUNCE_MAX_FRAMES) {
+            fprintf(stderr, "debounce: Invalid setting '%s', expected class=0-%d\n", tok, DEBOUNCE_MAX_FRAMES);
+            return -1;
+        }
+        *eq = '\0';
+
+        int c;
+        for (c = 0; c < DEBOUNCE_NUM_CLASSES; c++) {
+            if (strcmp(class_names[c], tok) == 0) {
+                frames[c] = (uint8_t)val;
+                break;
+            }
+        }
+        if (c == DEBOUNCE_NUM_CLASSES) {
+            fprintf(stderr, "debounce: Unknown control class %s\n", tok);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Debounce a validated frame in place. Bits outside the mask pass through;
+ * the CRC bytes are left as received.
+ */
+void debounce_frame(debounce_t* debounce, uint8_t* frame) {
+    uint64_t raw[DEBOUNCE_WORDS];
+    load_words(raw, frame);
+
+    if (!debounce->_primed) {
+        memcpy(debounce->_state, raw, sizeof(raw));
+        debounce->_primed = true;
+        return;
+    }
+
+    for (int w = 0; w < DEBOUNCE_WORDS; w++) {
+        uint64_t mask = debounce->_mask[w];
+        uint64_t state = debounce->_state[w];
+        uint64_t delta = (raw[w] ^ state) & mask;
+
+        /* count up where the input differs, back to zero where it doesn't */
+        uint64_t c0 = debounce->_count[0][w];
+        uint64_t c1 = debounce->_count[1][w];
+        uint64_t c2 = debounce->_count[2][w];
+        uint64_t n0 = ~c0 & delta;
+        uint64_t n1 = (c1 ^ c0) & delta;
+        uint64_t n2 = (c2 ^ (c1 & c0)) & delta;
+
+        /* stable for long enough, take the new value and restart */
+        uint64_t done = delta & ~((n0 ^ debounce->_limit[0][w]) |
+                                  (n1 ^ debounce->_limit[1][w]) |
+                                  (n2 ^ debounce->_limit[2][w]));
+        state ^= done;
+
+        debounce->_count[0][w] = n0 & ~done;
+        debounce->_count[1][w] = n1 & ~done;
+        debounce->_count[2][w] = n2 & ~done;
+        debounce->_state[w] = state;
+
+        raw[w] = (raw[w] & ~mask) | (state & mask);
+    }
+
+    memcpy(frame, raw, DEBOUNCE_FRAME_SIZE);
+}
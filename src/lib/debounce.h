@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom frame debouncing
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __DEBOUNCE_H_
+#define __DEBOUNCE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "protocol.h"
+
+#define DEBOUNCE_FRAME_SIZE     64
+#define DEBOUNCE_WORDS          (DEBOUNCE_FRAME_SIZE / 8)
+#define DEBOUNCE_MAX_FRAMES     7       /* 3 bit counters */
+
+/*
+ * Controls debounced as a class. The analog-like fields (jog, touch,
+ * rotary, tempo and vinyl speed) change every frame and are never
+ * debounced.
+ */
+enum debounce_class {
+    DEBOUNCE_BUTTONS,       /* every button, selectors included */
+    DEBOUNCE_SLIP_PADDLE,
+    DEBOUNCE_JOG_PRESS,
+    DEBOUNCE_NUM_CLASSES
+};
+
+/*
+ * A bit follows the input once it has read differently from the debounced
+ * value for frames[class] frames in a row; 0 or 1 passes it straight
+ * through. Every bit has its own counter, kept bit sliced across three
+ * words (vertical counters), so a whole frame is debounced with a few
+ * word operations regardless of how many controls are chattering.
+ */
+typedef struct debounce {
+    bool        enabled;
+    uint8_t     frames[DEBOUNCE_NUM_CLASSES];
+
+    bool        _primed;                        /* _state holds a frame */
+    uint64_t    _mask[DEBOUNCE_WORDS];          /* bits being debounced */
+    uint64_t    _limit[3][DEBOUNCE_WORDS];      /* frames per bit, bit sliced */
+    uint64_t    _count[3][DEBOUNCE_WORDS];
+    uint64_t    _state[DEBOUNCE_WORDS];         /* debounced bits */
+} debounce_t;
+
+int  debounce_init(debounce_t* debounce, const uint8_t frames[DEBOUNCE_NUM_CLASSES]);
+int  debounce_parse(uint8_t frames[DEBOUNCE_NUM_CLASSES], const char* str);
+void debounce_frame(debounce_t* debounce, uint8_t* frame);
+
+#endif /* __DEBOUNCE_H_ */
@@ -10,21 +10,22 @@
 #include <linux/uinput.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "subucom.h"
 
 #define NUM_BUTTONS 10
 button_def_t buttons[NUM_BUTTONS] = {
-    {.id = ROTARY_BUTTON, .byte = 0x0B, .bit = 0x10, .keycode = KEY_ENTER},
-    {.id = BACK,          .byte = 0x0B, .bit = 0x01, .keycode = KEY_BACKSPACE},
-    {.id = CUE,           .byte = 0x05, .bit = 0x02, .keycode = 0},
-    {.id = PLAY,          .byte = 0x05, .bit = 0x01, .keycode = 0},
-    {.id = BEAT_JUMP_REV, .byte = 0x05, .bit = 0x80, .keycode = KEY_LEFTCTRL},
-    {.id = BEAT_JUMP_FWD, .byte = 0x05, .bit = 0x40, .keycode = KEY_SPACE},
-    {.id = TRACK_REV,     .byte = 0x05, .bit = 0x20, .keycode = KEY_COMMA},
-    {.id = TRACK_FWD,     .byte = 0x05, .bit = 0x10, .keycode = KEY_DOT},
-    {.id = BEAT_LOOP_4,   .byte = 0x07, .bit = 0x10, .keycode = KEY_LEFTALT},
-    {.id = BEAT_LOOP_8,   .byte = 0x07, .bit = 0x20, .keycode = 0}
+    {.id = ROTARY_BUTTON, .byte = SUBUCOM_IN_ROTARY_SEL_BYTE,   .bit = SUBUCOM_IN_ROTARY_SEL_MASK,   .keycode = KEY_ENTER},
+    {.id = BACK,          .byte = SUBUCOM_IN_BACK_BYTE,         .bit = SUBUCOM_IN_BACK_MASK,         .keycode = KEY_BACKSPACE},
+    {.id = CUE,           .byte = SUBUCOM_IN_CUE_BYTE,          .bit = SUBUCOM_IN_CUE_MASK,          .keycode = 0},
+    {.id = PLAY,          .byte = SUBUCOM_IN_PLAY_BYTE,         .bit = SUBUCOM_IN_PLAY_MASK,         .keycode = 0},
+    {.id = BEAT_JUMP_REV, .byte = SUBUCOM_IN_BEATJUMP_REV_BYTE, .bit = SUBUCOM_IN_BEATJUMP_REV_MASK, .keycode = KEY_LEFTCTRL},
+    {.id = BEAT_JUMP_FWD, .byte = SUBUCOM_IN_BEATJUMP_FWD_BYTE, .bit = SUBUCOM_IN_BEATJUMP_FWD_MASK, .keycode = KEY_SPACE},
+    {.id = TRACK_REV,     .byte = SUBUCOM_IN_TRACK_REV_BYTE,    .bit = SUBUCOM_IN_TRACK_REV_MASK,    .keycode = KEY_COMMA},
+    {.id = TRACK_FWD,     .byte = SUBUCOM_IN_TRACK_FWD_BYTE,    .bit = SUBUCOM_IN_TRACK_FWD_MASK,    .keycode = KEY_DOT},
+    {.id = BEAT_LOOP_4,   .byte = SUBUCOM_IN_BEAT_LOOP_4_BYTE,  .bit = SUBUCOM_IN_BEAT_LOOP_4_MASK,  .keycode = KEY_LEFTALT},
+    {.id = BEAT_LOOP_8,   .byte = SUBUCOM_IN_BEAT_LOOP_8_BYTE,  .bit = SUBUCOM_IN_BEAT_LOOP_8_MASK,  .keycode = 0}
 };
 
 #define NUM_SLIP_STATES 3
@@ -36,14 +37,14 @@ selector_state_t slip_states[NUM_SLIP_STATES] = {
 
 #define NUM_SELECTORS 1
 selector_def_t selectors[NUM_SELECTORS] = {
-    {.id = SLIP, .byte = 0x04, .state_count = 3, .states = slip_states},
+    {.id = SLIP, .byte = SUBUCOM_IN_SLIP_PADDLE_BYTE, .mask = SUBUCOM_IN_SLIP_PADDLE_MASK, .state_count = 3, .states = slip_states},
 };
 
 #define NUM_ENCODERS 2
 encoder_def_t encoders[NUM_ENCODERS] = {
     {
         .id = ROTARY,      
-        .byte = 0x0E,
+        .byte = SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE,
         .dir_as_button = true, 
         .left_id = ROTARY_LEFT,
         .right_id = ROTARY_RIGHT,
@@ -52,7 +53,7 @@ encoder_def_t encoders[NUM_ENCODERS] = {
     },
     {
         .id = ENCODER_JOG,
-        .byte = 0x1C,
+        .byte = SUBUCOM_IN_JOG_SPEED_BYTE,
         .dir_as_button = false,
         .left_id = JOG_LEFT,   
         .right_id = JOG_RIGHT,
@@ -65,7 +66,7 @@ encoder_def_t encoders[NUM_ENCODERS] = {
 jog_def_t jogs[NUM_JOGS] = {
     {
         .id = JOG,
-        .byte = 0x1E,
+        .byte = SUBUCOM_IN_JOG_PRESS_BYTE,
         .dir_as_button = true,
         .button_keycode = KEY_LEFTCTRL,
         .left_keycode = KEY_KP4,
@@ -73,6 +74,13 @@ jog_def_t jogs[NUM_JOGS] = {
     },
 };
 
+void keymap_index_selector(selector_def_t* selector) {
+    memset(selector->state_index, -1, sizeof(selector->state_index));
+    for (int i=selector->state_count - 1 ; i>=0 ; i--) {
+        selector->state_index[selector->states[i].value & selector->mask] = i;
+    }
+}
+
 keymap_t* keymap_make() {
     keymap_t* keymap = (keymap_t *)calloc(1, sizeof(keymap_t));
 
@@ -88,15 +96,22 @@ keymap_t* keymap_make() {
     keymap->num_encoders = NUM_ENCODERS;
     keymap->num_jogs = NUM_JOGS;
 
+    keymap->layers[0] = keymap;
+    keymap->num_layers = 1;
+
     if (keymap == NULL) {
         printf("doom_keymap: Could not allocate keymap!\n");
         return NULL;
     }
 
+    for (int i=0 ; i<NUM_SELECTORS ; i++) {
+        keymap_index_selector(&selectors[i]);
+    }
+
     return keymap;
 }
 
-int keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd) {
+static int register_layer_keycodes(keymap_t* keymap, int uinput_fd) {
     uint32_t count = 0;
 
     for (int i=0 ; i<keymap->num_buttons ; i++) {
@@ -107,11 +122,13 @@ int keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd) {
         }
     }
 
-    for (int i=0 ; i<keymap->num_slip_states ; i++) {
-        uint32_t keycode = keymap->slip_states[i].keycode;
-        if (keycode != 0) {
-            ioctl(uinput_fd, UI_SET_KEYBIT, keycode);
-            count++;
+    for (int i=0 ; i<keymap->num_selectors ; i++) {
+        for (int j=0 ; j<keymap->selectors[i].state_count ; j++) {
+            uint32_t keycode = keymap->selectors[i].states[j].keycode;
+            if (keycode != 0) {
+                ioctl(uinput_fd, UI_SET_KEYBIT, keycode);
+                count++;
+            }
         }
     }
 
@@ -129,6 +146,11 @@ int keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd) {
     }
 
     for (int i=0 ; i<keymap->num_jogs ; i++) {
+        uint32_t button_keycode = keymap->jogs[i].button_keycode;
+        if (button_keycode != 0) {
+            ioctl(uinput_fd, UI_SET_KEYBIT, button_keycode);
+            count++;
+        }
         uint32_t left_keycode = keymap->jogs[i].left_keycode;
         if (left_keycode != 0) {
             ioctl(uinput_fd, UI_SET_KEYBIT, left_keycode);
@@ -144,6 +166,55 @@ int keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd) {
     return count;
 }
 
+int keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd) {
+    int count = register_layer_keycodes(keymap, uinput_fd);
+
+    for (int i=1 ; i<keymap->num_layers ; i++) {
+        count += register_layer_keycodes(keymap->layers[i], uinput_fd);
+    }
+
+    for (int i=0 ; keymap->combos != NULL && i<keymap->combos->num_combos ; i++) {
+        ioctl(uinput_fd, UI_SET_KEYBIT, keymap->combos->ids[i]);
+        count++;
+    }
+
+    for (int i=0 ; keymap->gestures != NULL && i<keymap->gestures->num_gestures ; i++) {
+        const gesture_def_t* gesture = &keymap->gestures->defs[i];
+        int keycodes[] = { gesture->keycode, gesture->left_keycode, gesture->right_keycode };
+        for (int j=0 ; j<3 ; j++) {
+            if (keycodes[j] != 0) {
+                ioctl(uinput_fd, UI_SET_KEYBIT, keycodes[j]);
+                count++;
+            }
+        }
+    }
+
+    if (keymap->num_led_bindings > 0) {
+        ioctl(uinput_fd, UI_SET_EVBIT, EV_LED);
+    }
+    for (int i=0 ; i<keymap->num_led_bindings ; i++) {
+        ioctl(uinput_fd, UI_SET_LEDBIT, keymap->led_bindings[i].code);
+    }
+
+    return count;
+}
+
 void keymap_free(keymap_t* keymap) {
+    for (int i=1 ; i<keymap->num_layers ; i++) {
+        keymap_free(keymap->layers[i]);
+    }
+
+    if (keymap->_allocated) {
+        for (int i=0 ; i<keymap->num_selectors ; i++) {
+            free(keymap->selectors[i].states);
+        }
+        free(keymap->buttons);
+        free(keymap->selectors);
+        free(keymap->encoders);
+        free(keymap->jogs);
+        free(keymap->combos);
+        free(keymap->gestures);
+        free(keymap->midi);
+    }
     free(keymap);
 }
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom gesture recognition
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gesture.h"
+#include "protocol.h"
+
+void gesture_history_push(gesture_history_t* history, const gesture_edge_t* edge) {
+    history->edges[history->count++ & (GESTURE_HISTORY_SIZE - 1)] = *edge;
+}
+
+/* age 0 is the newest edge, NULL once age reaches past the oldest one kept */
+const gesture_edge_t* gesture_history_get(const gesture_history_t* history, uint32_t age) {
+    if (age >= history->count || age >= GESTURE_HISTORY_SIZE) {
+        return NULL;
+    }
+    return &history->edges[(history->count - 1 - age) & (GESTURE_HISTORY_SIZE - 1)];
+}
+
+void gesture_set_init(gesture_set_t* gestures) {
+    memset(gestures, 0, sizeof(gesture_set_t));
+}
+
+int gesture_add(gesture_set_t* gestures, const gesture_def_t* def) {
+    if (gestures->num_gestures == GESTURE_MAX) {
+        fprintf(stderr, "gesture: Too many gestures\n");
+        return -1;
+    }
+
+    gestures->defs[gestures->num_gestures++] = *def;
+    return 0;
+}
+
+/*
+ * Advance the gestures an edge belongs to. Keycodes recognized on this edge
+ * are stored in keycodes, their number is returned.
+ */
+int gesture_edge(gesture_set_t* gestures, const gesture_edge_t* edge, const uint8_t* frame, int* keycodes, int max) {
+    int64_t t_ms = edge->t_us / 1000;
+    int n = 0;
+
+    for (int i = 0; i < gestures->num_gestures && n < max; i++) {
+        const gesture_def_t* def = &gestures->defs[i];
+
+        if (def->type == GESTURE_PRESS_TURN) {
+            if (edge->byte == SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE && (frame[def->byte] & def->bit)) {
+                int16_t steps = (int16_t)(edge->value - edge->prev);
+                int keycode = (steps > 0) ? def->right_keycode : def->left_keycode;
+                if (keycode != 0) {
+                    keycodes[n++] = keycode;
+                }
+            }
+            continue;
+        }
+
+        if (edge->byte != def->byte || ((edge->prev ^ edge->value) & def->bit) == 0) {
+            continue;
+        }
+        bool pressed = (edge->value & def->bit) != 0;
+
+        if (def->type == GESTURE_LONG_PRESS) {
+            if (pressed) {
+                gestures->_t_ms[i] = t_ms;
+                gestures->_armed |= 1u << i;
+            } else {
+                gestures->_armed &= ~(1u << i);
+            }
+        } else if (def->type == GESTURE_DOUBLE_TAP && pressed) {
+            if (gestures->_t_ms[i] != 0 && t_ms - gestures->_t_ms[i] <= def->time_ms) {
+                keycodes[n++] = def->keycode;
+                gestures->_t_ms[i] = 0;
+            } else {
+                gestures->_t_ms[i] = t_ms;
+            }
+        }
+    }
+
+    return n;
+}
+
+/* fire the long presses held for their time by now_ms */
+int gesture_tick(gesture_set_t* gestures, int64_t now_ms, int* keycodes, int max) {
+    uint32_t armed = gestures->_armed;
+    int n = 0;
+
+    while (armed != 0 && n < max) {
+        int i = __builtin_ctz(armed);
+        armed &= armed - 1;
+
+        if (now_ms - gestures->_t_ms[i] >= gestures->defs[i].time_ms) {
+            keycodes[n++] = gestures->defs[i].keycode;
+            gestures->_armed &= ~(1u << i);
+        }
+    }
+
+    return n;
+}
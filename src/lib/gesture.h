@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom gesture recognition
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __GESTURE_H_
+#define __GESTURE_H_
+
+#include <stdint.h>
+
+#define GESTURE_MAX             16
+#define GESTURE_HISTORY_SIZE    64      /* power of two */
+
+typedef enum gesture_type {
+    GESTURE_LONG_PRESS,     /* button held for time_ms */
+    GESTURE_DOUBLE_TAP,     /* button pressed twice within time_ms */
+    GESTURE_PRESS_TURN      /* rotary turned while the button is held */
+} gesture_type_t;
+
+/*
+ * One change of the input frame: a button byte (slip paddle up to USB_STOP)
+ * or the rotary encoder position, whose 16-bit value byte names.
+ */
+typedef struct gesture_edge {
+    int64_t  t_us;          /* arrival time of the frame, CLOCK_MONOTONIC */
+    uint8_t  byte;
+    uint16_t prev;
+    uint16_t value;
+} gesture_edge_t;
+
+/* the last GESTURE_HISTORY_SIZE edges, oldest overwritten first */
+typedef struct gesture_history {
+    gesture_edge_t edges[GESTURE_HISTORY_SIZE];
+    uint32_t       count;   /* edges pushed so far */
+} gesture_history_t;
+
+/* byte/bit as in button_def_t, keycodes are tapped once per recognition */
+typedef struct gesture_def {
+    gesture_type_t type;
+    uint8_t  byte;
+    uint8_t  bit;
+    uint32_t time_ms;
+    int      keycode;
+    int      left_keycode;  /* press and turn, per rotary step */
+    int      right_keycode;
+} gesture_def_t;
+
+typedef struct gesture_set {
+    gesture_def_t defs[GESTURE_MAX];
+    uint8_t  num_gestures;
+
+    uint32_t _armed;                /* long presses waiting for time_ms */
+    int64_t  _t_ms[GESTURE_MAX];    /* press (long press) or last tap (double tap) */
+} gesture_set_t;
+
+void                  gesture_history_push(gesture_history_t* history, const gesture_edge_t* edge);
+const gesture_edge_t* gesture_history_get(const gesture_history_t* history, uint32_t age);
+
+void gesture_set_init(gesture_set_t* gestures);
+int  gesture_add(gesture_set_t* gestures, const gesture_def_t* def);
+int  gesture_edge(gesture_set_t* gestures, const gesture_edge_t* edge, const uint8_t* frame, int* keycodes, int max);
+int  gesture_tick(gesture_set_t* gestures, int64_t now_ms, int* keycodes, int max);
+
+#endif /* __GESTURE_H_ */
@@ -12,6 +12,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "combo.h"
+#include "gesture.h"
+#include "midi.h"
+
 typedef enum button_type {
     ROTARY_BUTTON,
     BACK,
@@ -22,7 +26,46 @@ typedef enum button_type {
     TRACK_REV,
     TRACK_FWD,
     BEAT_LOOP_4,
-    BEAT_LOOP_8
+    BEAT_LOOP_8,
+    SEARCH_FWD,
+    SEARCH_REV,
+    TEMPO_RESET,
+    TEMPO_MASTER,
+    TEMPO_RANGE,
+    KEYSYNC,
+    BEATSYNC,
+    MASTER,
+    LOOP_IN,
+    LOOP_OUT,
+    RELOOP,
+    SLIP_BUTTON,
+    MEMORY,
+    MEM_DELETE,
+    MEM_CUE_FWD,
+    MEM_CUE_REV,
+    CALL_DELETE,
+    HOTCUE_A,
+    HOTCUE_B,
+    HOTCUE_C,
+    HOTCUE_D,
+    HOTCUE_E,
+    HOTCUE_F,
+    HOTCUE_G,
+    HOTCUE_H,
+    SOURCE,
+    BROWSE,
+    TAGLIST,
+    PLAYLIST,
+    SEARCH,
+    MENU,
+    JOG_MODE,
+    TAG_TRACK,
+    TRACK_FILTER,
+    SHORTCUT,
+    TIME,
+    QUANTIZE,
+    SD,
+    USB_STOP
 } button_type_t;
 
 typedef enum encoder_type {
@@ -37,14 +80,44 @@ typedef enum encoder_dir_type {
     JOG_RIGHT
 } encoder_dir_type_t;
 
+/* the slip paddle and the exclusive button groups of doc/subucom_fields.js */
 typedef enum selector_type {
-    SLIP
+    SLIP,
+    GROUP_SEARCH_TRACK,     /* group 1 */
+    GROUP_TEMPO_SYNC,       /* group 2 */
+    GROUP_MEMORY,           /* group 3 */
+    GROUP_BROWSE,           /* group 4 */
+    GROUP_NAVIGATE          /* group 5 */
 } selector_type_t;
 
 typedef enum selector_states {
     FWD,
     SLIP_REV,
-    REVERSE
+    REVERSE,
+    SEL_SEARCH_FWD,
+    SEL_SEARCH_REV,
+    SEL_TRACK_FWD,
+    SEL_TRACK_REV,
+    SEL_TEMPO_MASTER,
+    SEL_TEMPO_RANGE,
+    SEL_KEYSYNC,
+    SEL_BEATSYNC,
+    SEL_MASTER,
+    SEL_MEMORY,
+    SEL_MEM_DELETE,
+    SEL_MEM_CUE_FWD,
+    SEL_MEM_CUE_REV,
+    SEL_SOURCE,
+    SEL_BROWSE,
+    SEL_TAGLIST,
+    SEL_PLAYLIST,
+    SEL_SEARCH,
+    SEL_MENU,
+    SEL_BACK,
+    SEL_TAG_TRACK,
+    SEL_TRACK_FILTER,
+    SEL_SHORTCUT,
+    SEL_ROTARY_SEL
 } selector_states_t;
 
 typedef enum jog_type {
@@ -66,11 +139,21 @@ typedef struct selector_state {
     int keycode;
 } selector_state_t;
 
+#define SELECTOR_MAX_STATES 8
+
+/*
+ * A selector is in at most one state at a time. (frame[byte] & mask) indexes
+ * state_index, which holds the matching entry of states or -1, so decoding
+ * doesn't depend on the number of states. Fill it with keymap_index_selector
+ * whenever the state values change.
+ */
 typedef struct selector_def {
     selector_type_t id;
     uint8_t byte;
+    uint8_t mask;
     uint8_t state_count;
     selector_state_t *states;
+    int8_t state_index[256];
 } selector_def_t;
 
 typedef struct encoder_def {
@@ -92,6 +175,45 @@ typedef struct jog_def {
     int right_keycode;
 } jog_def_t;
 
+#define KEYMAP_MAX_LAYERS 8
+#define KEYMAP_MAX_LED_BINDINGS 32
+
+/* last keycode a keymap may use, uinput registers KEY_ESC up to here */
+#define KEYMAP_MAX_KEYCODE KEY_MICMUTE
+
+/* evdev LED code lighting an LED of the output frame (a led_id_t) */
+typedef struct led_binding {
+    uint8_t code;
+    uint8_t led;
+} led_binding_t;
+
+#define KEYMAP_MAX_FEEDBACK 32
+
+/*
+ * Local feedback: while (frame[byte] & mask) == value the LED shows level,
+ * blinking with blink_ms period if set, otherwise it is off.
+ */
+typedef struct feedback_def {
+    uint8_t byte;
+    uint8_t mask;
+    uint8_t value;
+    uint8_t led;
+    uint8_t level;
+    uint16_t blink_ms;
+} feedback_def_t;
+
+typedef enum layer_mode {
+    LAYER_MOMENTARY,    /* layer active while the switch is held */
+    LAYER_LATCHED       /* each press toggles the layer on or off */
+} layer_mode_t;
+
+typedef struct layer_switch_def {
+    uint8_t layer;
+    uint8_t byte;
+    uint8_t bit;
+    layer_mode_t mode;
+} layer_switch_def_t;
+
 typedef struct keymap {
     button_def_t *buttons;
     selector_state_t *slip_states;
@@ -104,10 +226,46 @@ typedef struct keymap {
     uint8_t num_selectors;
     uint8_t num_encoders;
     uint8_t num_jogs;
+
+    /*
+     * Every layer is a complete set of tables, layers[0] being the keymap
+     * itself, so switching layers only swaps the table the decoders use.
+     */
+    struct keymap *layers[KEYMAP_MAX_LAYERS];
+    layer_switch_def_t layer_switches[KEYMAP_MAX_LAYERS];
+    uint8_t num_layers;
+    uint8_t num_layer_switches;
+
+    /* combos, the combo id is the keycode emitted when it fires */
+    combo_set_t *combos;
+
+    /* gestures, like combos they apply whatever layer is active */
+    gesture_set_t *gestures;
+
+    /* EV_LED codes written to the uinput device, one entry per lit LED */
+    led_binding_t led_bindings[KEYMAP_MAX_LED_BINDINGS];
+    uint8_t num_led_bindings;
+
+    feedback_def_t feedback[KEYMAP_MAX_FEEDBACK];
+    uint8_t num_feedback;
+
+    /* MIDI messages for the keycodes and continuous controls, or NULL */
+    midi_map_t *midi;
+
+    bool _allocated; /* tables are heap allocated (loaded from file) */
 } keymap_t;
 
 keymap_t* keymap_make();
 int       keymap_register_uinput_keycodes(keymap_t* keymap, int uinput_fd);
 void      keymap_free(keymap_t* keymap);
+void      keymap_index_selector(selector_def_t* selector);
+
+/* keymap files */
+keymap_t* keymap_load(const char* path);
+int       keymap_keycode_from_name(const char *name);
+int       keymap_led_code_from_name(const char *name);
+
+int       keymap_watch_init(const char* path);
+bool      keymap_watch_changed(int watch_fd, const char* path);
 
 #endif // __KEYMAP_H_
\ No newline at end of file
@@ -0,0 +1,1101 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  Keymap file loader for CDJ3K subucom
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+/*
+ * Keymap files are INI-like text files that bind the physical controls to
+ * Linux key codes, e.g.:
+ *
+ *   # comment
+ *   [buttons]
+ *   ROTARY_SEL = KEY_ENTER
+ *   BACK       = KEY_BACKSPACE
+ *
+ *   [selector SLIP_PADDLE]
+ *   SLIP_REV   = KEY_KP8
+ *   REVERSE    = KEY_KP2
+ *
+ *   [selector BROWSE_GROUP]    # exclusive buttons, see selector_controls
+ *   BROWSE     = KEY_B
+ *
+ *   [encoder ROTARY]
+ *   left       = KEY_UP
+ *   right      = KEY_DOWN
+ *
+ *   [jog JOG]
+ *   button     = KEY_LEFTCTRL
+ *   left       = KEY_KP4
+ *   right      = KEY_KP6
+ *
+ *   [layer shift]
+ *   switch     = SHORTCUT      # any button
+ *   mode       = momentary     # or latched
+ *
+ *   [buttons]                  # bindings of the shift layer from here on
+ *   HOTCUE_A   = KEY_F1
+ *
+ * Sections after a [layer] header belong to that layer. Controls a layer
+ * doesn't bind keep their base keymap binding.
+ *
+ *   [combo service]
+ *   keys       = TRACK_FWD + LOOP_IN
+ *   exact      = true          # no other button may be held
+ *   hold       = 2000          # ms, optional
+ *   key        = KEY_F12       # emitted once when the combo fires
+ *
+ * Combos apply whatever layer is active.
+ *
+ *   [gesture hold_a]
+ *   type       = long_press    # or double_tap, press_turn
+ *   button     = HOTCUE_A
+ *   time       = 600           # ms held, or at most between two taps
+ *   key        = KEY_F1        # emitted once per long press or double tap
+ *
+ *   [gesture shift_turn]
+ *   type       = press_turn
+ *   button     = SHORTCUT
+ *   left       = KEY_PAGEUP    # emitted per rotary step while held
+ *   right      = KEY_PAGEDOWN
+ *
+ * Gestures are recognized on top of the regular button bindings, whatever
+ * layer is active.
+ *
+ *   [leds]
+ *   MISC       = PLAY                      # evdev LED code = output LED(s)
+ *   11         = HOTCUE_A_R + HOTCUE_A_G   # unnamed codes up to LED_MAX
+ *
+ * Applications light the LEDs by writing EV_LED events to the input device.
+ * A set evdev LED turns its LEDs fully on, see leds.h for the LED names.
+ *
+ *   [feedback]
+ *   PLAY                 = PLAY                # lit while held
+ *   HOTCUE_A             = HOTCUE_A_G 0x0F     # at a given level
+ *   CUE                  = CUE blink 250       # blinking, period in ms
+ *   SLIP_PADDLE.REVERSE  = REV                 # while a selector is in a state
+ *
+ * Feedback is evaluated while decoding each frame, so the LED follows the
+ * control within one scan interval without any other process involved.
+ *
+ * Control names follow doc/subucom_fields.js. The file is compiled into the same
+ * button/selector/encoder/jog tables as the built-in keymap, so decoding
+ * costs the same whichever keymap is loaded.
+ */
+
+#include <errno.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "keymap.h"
+#include "leds.h"
+#include "subucom.h"
+
+#define LINE_MAX_LEN  256
+
+typedef struct button_control {
+    const char *name;
+    button_type_t id;
+    uint8_t byte;
+    uint8_t bit;
+} button_control_t;
+
+/* name as in doc/subucom_fields.js, so the offsets come from protocol.h */
+#define BUTTON(name, id) { #name, id, SUBUCOM_IN_##name##_BYTE, SUBUCOM_IN_##name##_MASK }
+
+static const button_control_t button_controls[] = {
+    BUTTON(PLAY,         PLAY),
+    BUTTON(CUE,          CUE),
+    BUTTON(SEARCH_FWD,   SEARCH_FWD),
+    BUTTON(SEARCH_REV,   SEARCH_REV),
+    BUTTON(TRACK_FWD,    TRACK_FWD),
+    BUTTON(TRACK_REV,    TRACK_REV),
+    BUTTON(BEATJUMP_FWD, BEAT_JUMP_FWD),
+    BUTTON(BEATJUMP_REV, BEAT_JUMP_REV),
+    BUTTON(TEMPO_RESET,  TEMPO_RESET),
+    BUTTON(TEMPO_MASTER, TEMPO_MASTER),
+    BUTTON(TEMPO_RANGE,  TEMPO_RANGE),
+    BUTTON(KEYSYNC,      KEYSYNC),
+    BUTTON(BEATSYNC,     BEATSYNC),
+    BUTTON(MASTER,       MASTER),
+    BUTTON(LOOP_IN,      LOOP_IN),
+    BUTTON(LOOP_OUT,     LOOP_OUT),
+    BUTTON(RELOOP,       RELOOP),
+    BUTTON(BEAT_LOOP_4,  BEAT_LOOP_4),
+    BUTTON(BEAT_LOOP_8,  BEAT_LOOP_8),
+    BUTTON(SLIP,         SLIP_BUTTON),
+    BUTTON(MEMORY,       MEMORY),
+    BUTTON(MEM_DELETE,   MEM_DELETE),
+    BUTTON(MEM_CUE_FWD,  MEM_CUE_FWD),
+    BUTTON(MEM_CUE_REV,  MEM_CUE_REV),
+    BUTTON(CALL_DELETE,  CALL_DELETE),
+    BUTTON(HOTCUE_A,     HOTCUE_A),
+    BUTTON(HOTCUE_B,     HOTCUE_B),
+    BUTTON(HOTCUE_C,     HOTCUE_C),
+    BUTTON(HOTCUE_D,     HOTCUE_D),
+    BUTTON(HOTCUE_E,     HOTCUE_E),
+    BUTTON(HOTCUE_F,     HOTCUE_F),
+    BUTTON(HOTCUE_G,     HOTCUE_G),
+    BUTTON(HOTCUE_H,     HOTCUE_H),
+    BUTTON(SOURCE,       SOURCE),
+    BUTTON(BROWSE,       BROWSE),
+    BUTTON(TAGLIST,      TAGLIST),
+    BUTTON(PLAYLIST,     PLAYLIST),
+    BUTTON(SEARCH,       SEARCH),
+    BUTTON(MENU,         MENU),
+    BUTTON(JOG_MODE,     JOG_MODE),
+    BUTTON(BACK,         BACK),
+    BUTTON(TAG_TRACK,    TAG_TRACK),
+    BUTTON(TRACK_FILTER, TRACK_FILTER),
+    BUTTON(SHORTCUT,     SHORTCUT),
+    BUTTON(ROTARY_SEL,   ROTARY_BUTTON),
+    BUTTON(TIME,         TIME),
+    BUTTON(QUANTIZE,     QUANTIZE),
+    BUTTON(SD,           SD),
+    BUTTON(USB_STOP,     USB_STOP),
+};
+#define NUM_BUTTON_CONTROLS (sizeof(button_controls) / sizeof(button_controls[0]))
+
+typedef struct selector_control {
+    const char *name;
+    selector_type_t id;
+    uint8_t byte;
+    uint8_t mask;
+    uint8_t state_count;
+    const char *state_names[SELECTOR_MAX_STATES];
+    selector_states_t state_ids[SELECTOR_MAX_STATES];
+    uint8_t state_values[SELECTOR_MAX_STATES];
+} selector_control_t;
+
+#define STATE(name) SUBUCOM_IN_##name##_MASK
+
+/*
+ * The buttons of an exclusive group (the superscripts in doc/subucom_fields.js)
+ * can't be held together, so each group decodes as one selector with a
+ * state per button. Their [buttons] bindings keep working as well.
+ */
+static const selector_control_t selector_controls[] = {
+    {
+        "SLIP_PADDLE", SLIP, SUBUCOM_IN_SLIP_PADDLE_BYTE, SUBUCOM_IN_SLIP_PADDLE_MASK, 3,
+        { "FWD", "SLIP_REV", "REVERSE" },
+        { FWD, SLIP_REV, REVERSE },
+        { 0x03, 0x02, 0x01 }
+    },
+    {
+        "SEARCH_TRACK_GROUP", GROUP_SEARCH_TRACK, SUBUCOM_IN_GROUP1_BYTE, SUBUCOM_IN_GROUP1_MASK, 4,
+        { "SEARCH_FWD", "SEARCH_REV", "TRACK_FWD", "TRACK_REV" },
+        { SEL_SEARCH_FWD, SEL_SEARCH_REV, SEL_TRACK_FWD, SEL_TRACK_REV },
+        { STATE(SEARCH_FWD), STATE(SEARCH_REV), STATE(TRACK_FWD), STATE(TRACK_REV) }
+    },
+    {
+        "TEMPO_SYNC_GROUP", GROUP_TEMPO_SYNC, SUBUCOM_IN_GROUP2_BYTE, SUBUCOM_IN_GROUP2_MASK, 5,
+        { "TEMPO_MASTER", "TEMPO_RANGE", "KEYSYNC", "BEATSYNC", "MASTER" },
+        { SEL_TEMPO_MASTER, SEL_TEMPO_RANGE, SEL_KEYSYNC, SEL_BEATSYNC, SEL_MASTER },
+        { STATE(TEMPO_MASTER), STATE(TEMPO_RANGE), STATE(KEYSYNC), STATE(BEATSYNC), STATE(MASTER) }
+    },
+    {
+        "MEMORY_GROUP", GROUP_MEMORY, SUBUCOM_IN_GROUP3_BYTE, SUBUCOM_IN_GROUP3_MASK, 4,
+        { "MEMORY", "MEM_DELETE", "MEM_CUE_FWD", "MEM_CUE_REV" },
+        { SEL_MEMORY, SEL_MEM_DELETE, SEL_MEM_CUE_FWD, SEL_MEM_CUE_REV },
+        { STATE(MEMORY), STATE(MEM_DELETE), STATE(MEM_CUE_FWD), STATE(MEM_CUE_REV) }
+    },
+    {
+        "BROWSE_GROUP", GROUP_BROWSE, SUBUCOM_IN_GROUP4_BYTE, SUBUCOM_IN_GROUP4_MASK, 6,
+        { "SOURCE", "BROWSE", "TAGLIST", "PLAYLIST", "SEARCH", "MENU" },
+        { SEL_SOURCE, SEL_BROWSE, SEL_TAGLIST, SEL_PLAYLIST, SEL_SEARCH, SEL_MENU },
+        { STATE(SOURCE), STATE(BROWSE), STATE(TAGLIST), STATE(PLAYLIST), STATE(SEARCH), STATE(MENU) }
+    },
+    {
+        "NAVIGATE_GROUP", GROUP_NAVIGATE, SUBUCOM_IN_GROUP5_BYTE, SUBUCOM_IN_GROUP5_MASK, 5,
+        { "BACK", "TAG_TRACK", "TRACK_FILTER", "SHORTCUT", "ROTARY_SEL" },
+        { SEL_BACK, SEL_TAG_TRACK, SEL_TRACK_FILTER, SEL_SHORTCUT, SEL_ROTARY_SEL },
+        { STATE(BACK), STATE(TAG_TRACK), STATE(TRACK_FILTER), STATE(SHORTCUT), STATE(ROTARY_SEL) }
+    },
+};
+#define NUM_SELECTOR_CONTROLS (sizeof(selector_controls) / sizeof(selector_controls[0]))
+
+typedef struct encoder_control {
+    const char *name;
+    encoder_type_t id;
+    uint8_t byte;
+    encoder_dir_type_t left_id;
+    encoder_dir_type_t right_id;
+} encoder_control_t;
+
+/* encoders are decoded as 16-bit big endian counters */
+_Static_assert(SUBUCOM_IN_ROTARY_ENCODER_POS_WIDTH == 16, "ROTARY must be a 16-bit field");
+_Static_assert(SUBUCOM_IN_JOG_SPEED_WIDTH == 16, "ENCODER_JOG must be a 16-bit field");
+
+static const encoder_control_t encoder_controls[] = {
+    { "ROTARY",      ROTARY,      SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE, ROTARY_LEFT, ROTARY_RIGHT },
+    { "ENCODER_JOG", ENCODER_JOG, SUBUCOM_IN_JOG_SPEED_BYTE,          JOG_LEFT,    JOG_RIGHT },
+};
+#define NUM_ENCODER_CONTROLS (sizeof(encoder_controls) / sizeof(encoder_controls[0]))
+
+typedef struct jog_control {
+    const char *name;
+    jog_type_t id;
+    uint8_t byte;
+} jog_control_t;
+
+static const jog_control_t jog_controls[] = {
+    { "JOG", JOG, SUBUCOM_IN_JOG_PRESS_BYTE },
+};
+#define NUM_JOG_CONTROLS (sizeof(jog_controls) / sizeof(jog_controls[0]))
+
+enum section {
+    SECTION_NONE,
+    SECTION_BUTTONS,
+    SECTION_SELECTOR,
+    SECTION_ENCODER,
+    SECTION_JOG,
+    SECTION_LAYER,
+    SECTION_COMBO,
+    SECTION_LEDS,
+    SECTION_FEEDBACK,
+    SECTION_GESTURE,
+    SECTION_MIDI
+};
+
+#define COMBO_MAX_KEYS  8
+
+typedef struct pending_combo {
+    bool active;
+    int line_no;
+    combo_key_t keys[COMBO_MAX_KEYS];
+    uint8_t num_keys;
+    bool exact;
+    uint32_t hold_ms;
+    int keycode;
+} pending_combo_t;
+
+#define GESTURE_LONG_PRESS_MS   500
+#define GESTURE_DOUBLE_TAP_MS   300
+
+typedef struct pending_gesture {
+    bool active;
+    int line_no;
+    bool has_button;
+    gesture_def_t def;
+} pending_gesture_t;
+
+static char* trim(char* str) {
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+
+    char* end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) {
+        end--;
+    }
+    *end = '\0';
+
+    return str;
+}
+
+static bool has_button(const keymap_t* keymap, button_type_t id) {
+    for (int i = 0; i < keymap->num_buttons; i++) {
+        if (keymap->buttons[i].id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* every selector, encoder and jog can only have one section */
+static bool has_section(const keymap_t* keymap, const char* type, const char* name) {
+    if (strcmp(type, "selector") == 0) {
+        for (size_t i = 0; i < NUM_SELECTOR_CONTROLS; i++) {
+            if (strcmp(selector_controls[i].name, name) != 0) {
+                continue;
+            }
+            for (int j = 0; j < keymap->num_selectors; j++) {
+                if (keymap->selectors[j].id == selector_controls[i].id) {
+                    return true;
+                }
+            }
+        }
+    } else if (strcmp(type, "encoder") == 0) {
+        for (size_t i = 0; i < NUM_ENCODER_CONTROLS; i++) {
+            if (strcmp(encoder_controls[i].name, name) != 0) {
+                continue;
+            }
+            for (int j = 0; j < keymap->num_encoders; j++) {
+                if (keymap->encoders[j].id == encoder_controls[i].id) {
+                    return true;
+                }
+            }
+        }
+    } else if (strcmp(type, "jog") == 0) {
+        for (size_t i = 0; i < NUM_JOG_CONTROLS; i++) {
+            if (strcmp(jog_controls[i].name, name) != 0) {
+                continue;
+            }
+            for (int j = 0; j < keymap->num_jogs; j++) {
+                if (keymap->jogs[j].id == jog_controls[i].id) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static keymap_t* alloc_keymap() {
+    keymap_t* keymap = (keymap_t *)calloc(1, sizeof(keymap_t));
+    if (keymap == NULL) {
+        return NULL;
+    }
+
+    keymap->_allocated = true;
+    keymap->buttons = (button_def_t *)calloc(NUM_BUTTON_CONTROLS, sizeof(button_def_t));
+    keymap->selectors = (selector_def_t *)calloc(NUM_SELECTOR_CONTROLS, sizeof(selector_def_t));
+    keymap->encoders = (encoder_def_t *)calloc(NUM_ENCODER_CONTROLS, sizeof(encoder_def_t));
+    keymap->jogs = (jog_def_t *)calloc(NUM_JOG_CONTROLS, sizeof(jog_def_t));
+
+    if (keymap->buttons == NULL || keymap->selectors == NULL ||
+        keymap->encoders == NULL || keymap->jogs == NULL) {
+        keymap_free(keymap);
+        return NULL;
+    }
+
+    return keymap;
+}
+
+static const button_control_t* find_button_control(const char* name) {
+    for (size_t i = 0; i < NUM_BUTTON_CONTROLS; i++) {
+        if (strcmp(button_controls[i].name, name) == 0) {
+            return &button_controls[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Controls a layer leaves unbound fall through to the base keymap, so that
+ * e.g. the jog keeps working while a shift layer is active.
+ */
+static int inherit_base(keymap_t* layer, const keymap_t* base) {
+    for (int i = 0; i < base->num_buttons; i++) {
+        if (!has_button(layer, base->buttons[i].id)) {
+            layer->buttons[layer->num_buttons++] = base->buttons[i];
+        }
+    }
+
+    for (int i = 0; i < base->num_selectors; i++) {
+        bool found = false;
+        for (int j = 0; j < layer->num_selectors; j++) {
+            found |= (layer->selectors[j].id == base->selectors[i].id);
+        }
+        if (!found) {
+            selector_def_t* selector = &layer->selectors[layer->num_selectors++];
+            *selector = base->selectors[i];
+            selector->states = (selector_state_t *)malloc(selector->state_count * sizeof(selector_state_t));
+            if (selector->states == NULL) {
+                return -1;
+            }
+            memcpy(selector->states, base->selectors[i].states, selector->state_count * sizeof(selector_state_t));
+        }
+    }
+
+    for (int i = 0; i < base->num_encoders; i++) {
+        bool found = false;
+        for (int j = 0; j < layer->num_encoders; j++) {
+            found |= (layer->encoders[j].id == base->encoders[i].id);
+        }
+        if (!found) {
+            layer->encoders[layer->num_encoders++] = base->encoders[i];
+        }
+    }
+
+    for (int i = 0; i < base->num_jogs; i++) {
+        bool found = false;
+        for (int j = 0; j < layer->num_jogs; j++) {
+            found |= (layer->jogs[j].id == base->jogs[i].id);
+        }
+        if (!found) {
+            layer->jogs[layer->num_jogs++] = base->jogs[i];
+        }
+    }
+
+    for (int i = 0; i < layer->num_selectors; i++) {
+        if (layer->selectors[i].id == SLIP) {
+            layer->slip_states = layer->selectors[i].states;
+            layer->num_slip_states = layer->selectors[i].state_count;
+        }
+    }
+
+    return 0;
+}
+
+/* check the layer setup once the whole file has been read */
+static int finish_layers(keymap_t* keymap, const char* path) {
+    for (int i = 1; i < keymap->num_layers; i++) {
+        bool has_switch = false;
+        for (int j = 0; j < keymap->num_layer_switches; j++) {
+            has_switch |= (keymap->layer_switches[j].layer == i);
+        }
+        if (!has_switch) {
+            fprintf(stderr, "keymap: %s: layer %d has no switch\n", path, i);
+            return -1;
+        }
+    }
+
+    /* a layer switch can't emit keys itself, in any layer */
+    for (int i = 0; i < keymap->num_layer_switches; i++) {
+        const layer_switch_def_t* layer_switch = &keymap->layer_switches[i];
+        if (layer_switch->bit == 0) {
+            fprintf(stderr, "keymap: %s: layer %d: switch not set\n", path, layer_switch->layer);
+            return -1;
+        }
+        for (int l = 0; l < keymap->num_layers; l++) {
+            const keymap_t* layer = keymap->layers[l];
+            for (int j = 0; j < layer->num_buttons; j++) {
+                if (layer->buttons[j].byte == layer_switch->byte && layer->buttons[j].bit == layer_switch->bit) {
+                    fprintf(stderr, "keymap: %s: layer switch is also bound to a key\n", path);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    for (int i = 1; i < keymap->num_layers; i++) {
+        if (inherit_base(keymap->layers[i], keymap) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int parse_combo_keys(pending_combo_t* combo, char* value) {
+    char* save = NULL;
+    for (char* tok = strtok_r(value, "+", &save); tok != NULL; tok = strtok_r(NULL, "+", &save)) {
+        const button_control_t* control = find_button_control(trim(tok));
+        if (control == NULL || combo->num_keys == COMBO_MAX_KEYS) {
+            return -1;
+        }
+        combo->keys[combo->num_keys].byte = control->byte;
+        combo->keys[combo->num_keys].bit = control->bit;
+        combo->num_keys++;
+    }
+    return (combo->num_keys > 0) ? 0 : -1;
+}
+
+/* compile a finished [combo] section into the combo set */
+static int flush_combo(keymap_t* keymap, pending_combo_t* combo, const char* path) {
+    if (!combo->active) {
+        return 0;
+    }
+    combo->active = false;
+
+    if (combo->num_keys == 0 || combo->keycode <= 0) {
+        fprintf(stderr, "keymap: %s:%d: combo needs keys and a key\n", path, combo->line_no);
+        return -1;
+    }
+
+    if (keymap->combos == NULL) {
+        keymap->combos = (combo_set_t *)malloc(sizeof(combo_set_t));
+        if (keymap->combos == NULL) {
+            return -1;
+        }
+        combo_set_init(keymap->combos);
+    }
+
+    if (combo_add(keymap->combos, combo->keycode, combo->keys, combo->num_keys, combo->exact, combo->hold_ms) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_gesture_setting(pending_gesture_t* gesture, const char* key, const char* value) {
+    gesture_def_t* def = &gesture->def;
+
+    if (strcmp(key, "type") == 0) {
+        if (strcmp(value, "long_press") == 0) {
+            def->type = GESTURE_LONG_PRESS;
+        } else if (strcmp(value, "double_tap") == 0) {
+            def->type = GESTURE_DOUBLE_TAP;
+        } else if (strcmp(value, "press_turn") == 0) {
+            def->type = GESTURE_PRESS_TURN;
+        } else {
+            return -1;
+        }
+    } else if (strcmp(key, "button") == 0) {
+        const button_control_t* control = find_button_control(value);
+        if (control == NULL) {
+            return -1;
+        }
+        def->byte = control->byte;
+        def->bit = control->bit;
+        gesture->has_button = true;
+    } else if (strcmp(key, "time") == 0) {
+        def->time_ms = (uint32_t)strtoul(value, NULL, 10);
+    } else if (strcmp(key, "key") == 0) {
+        def->keycode = keymap_keycode_from_name(value);
+        return (def->keycode > 0) ? 0 : -1;
+    } else if (strcmp(key, "left") == 0) {
+        def->left_keycode = keymap_keycode_from_name(value);
+        return (def->left_keycode > 0) ? 0 : -1;
+    } else if (strcmp(key, "right") == 0) {
+        def->right_keycode = keymap_keycode_from_name(value);
+        return (def->right_keycode > 0) ? 0 : -1;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/* add a finished [gesture] section to the gesture set */
+static int flush_gesture(keymap_t* keymap, pending_gesture_t* gesture, const char* path) {
+    if (!gesture->active) {
+        return 0;
+    }
+    gesture->active = false;
+
+    gesture_def_t* def = &gesture->def;
+    bool has_keys = (def->type == GESTURE_PRESS_TURN)
+        ? (def->left_keycode > 0 || def->right_keycode > 0)
+        : (def->keycode > 0);
+    if (!gesture->has_button || !has_keys) {
+        fprintf(stderr, "keymap: %s:%d: gesture needs a button and its keys\n", path, gesture->line_no);
+        return -1;
+    }
+
+    if (def->time_ms == 0) {
+        def->time_ms = (def->type == GESTURE_DOUBLE_TAP) ? GESTURE_DOUBLE_TAP_MS : GESTURE_LONG_PRESS_MS;
+    }
+
+    if (keymap->gestures == NULL) {
+        keymap->gestures = (gesture_set_t *)malloc(sizeof(gesture_set_t));
+        if (keymap->gestures == NULL) {
+            return -1;
+        }
+        gesture_set_init(keymap->gestures);
+    }
+
+    return gesture_add(keymap->gestures, def);
+}
+
+static int parse_led_binding(keymap_t* keymap, const char* key, char* value) {
+    int code = keymap_led_code_from_name(key);
+    if (code < 0) {
+        return -1;
+    }
+
+    char* save = NULL;
+    for (char* tok = strtok_r(value, "+", &save); tok != NULL; tok = strtok_r(NULL, "+", &save)) {
+        int led = led_find(trim(tok));
+        if (led < 0 || keymap->num_led_bindings == KEYMAP_MAX_LED_BINDINGS) {
+            return -1;
+        }
+        keymap->led_bindings[keymap->num_led_bindings].code = code;
+        keymap->led_bindings[keymap->num_led_bindings].led = led;
+        keymap->num_led_bindings++;
+    }
+
+    return 0;
+}
+
+/* "CONTROL" or "SELECTOR.STATE" = "LED [level] [blink ms]" */
+static int parse_feedback(keymap_t* keymap, char* key, char* value) {
+    if (keymap->num_feedback == KEYMAP_MAX_FEEDBACK) {
+        return -1;
+    }
+    feedback_def_t* feedback = &keymap->feedback[keymap->num_feedback];
+
+    char* state = strchr(key, '.');
+    if (state == NULL) {
+        const button_control_t* control = find_button_control(key);
+        if (control == NULL) {
+            return -1;
+        }
+        feedback->byte = control->byte;
+        feedback->mask = control->bit;
+        feedback->value = control->bit;
+    } else {
+        *state++ = '\0';
+        const selector_control_t* control = NULL;
+        for (size_t i = 0; i < NUM_SELECTOR_CONTROLS; i++) {
+            if (strcmp(selector_controls[i].name, key) == 0) {
+                control = &selector_controls[i];
+            }
+        }
+        int j = 0;
+        while (control != NULL && j < control->state_count && strcmp(control->state_names[j], state) != 0) {
+            j++;
+        }
+        if (control == NULL || j == control->state_count) {
+            return -1;
+        }
+        /* same match as the selector decoder */
+        feedback->byte = control->byte;
+        feedback->mask = control->mask;
+        feedback->value = control->state_values[j];
+    }
+
+    char* save = NULL;
+    char* tok = strtok_r(value, " \t", &save);
+    int led = (tok != NULL) ? led_find(tok) : -1;
+    if (led < 0) {
+        return -1;
+    }
+    feedback->led = led;
+    feedback->level = (uint8_t)((1u << led_defs[led].width) - 1);
+    feedback->blink_ms = 0;
+
+    while ((tok = strtok_r(NULL, " \t", &save)) != NULL) {
+        char* end;
+        if (strcmp(tok, "blink") == 0) {
+            tok = strtok_r(NULL, " \t", &save);
+            unsigned long blink_ms = (tok != NULL) ? strtoul(tok, &end, 10) : 0;
+            if (blink_ms < 2 || blink_ms > UINT16_MAX || *end != '\0') {
+                return -1;
+            }
+            feedback->blink_ms = (uint16_t)blink_ms;
+        } else {
+            unsigned long level = strtoul(tok, &end, 0);
+            if (*end != '\0' || level >= (1u << led_defs[led].width)) {
+                return -1;
+            }
+            feedback->level = (uint8_t)level;
+        }
+    }
+
+    keymap->num_feedback++;
+    return 0;
+}
+
+static int parse_keycode(const char* path, int line_no, const char* value) {
+    int keycode = keymap_keycode_from_name(value);
+    if (keycode < 0) {
+        fprintf(stderr, "keymap: %s:%d: unknown key '%s'\n", path, line_no, value);
+    }
+    return keycode;
+}
+
+keymap_t* keymap_load(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "keymap: Error opening %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    keymap_t* keymap = alloc_keymap();
+    if (keymap == NULL) {
+        fclose(fp);
+        return NULL;
+    }
+    keymap->layers[0] = keymap;
+    keymap->num_layers = 1;
+
+    /* sections apply to the base keymap until the first [layer] */
+    keymap_t* target = keymap;
+    layer_switch_def_t* layer_switch = NULL;
+    pending_combo_t combo = { 0 };
+    pending_gesture_t gesture = { 0 };
+
+    char line[LINE_MAX_LEN];
+    int line_no = 0;
+    int err = 0;
+    enum section section = SECTION_NONE;
+    selector_def_t* selector = NULL;
+    const selector_control_t* selector_control = NULL;
+    encoder_def_t* encoder = NULL;
+    jog_def_t* jog = NULL;
+
+    while (err == 0 && fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+
+        char* comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+
+        char* str = trim(line);
+        if (*str == '\0') {
+            continue;
+        }
+
+        /* section header */
+        if (*str == '[') {
+            char* end = strchr(str, ']');
+            if (end == NULL) {
+                fprintf(stderr, "keymap: %s:%d: unterminated section\n", path, line_no);
+                err = -1;
+                break;
+            }
+            *end = '\0';
+
+            char* type = trim(str + 1);
+            char* name = strpbrk(type, " \t");
+            if (name != NULL) {
+                *name++ = '\0';
+                name = trim(name);
+            }
+
+            if (flush_combo(keymap, &combo, path) != 0 || flush_gesture(keymap, &gesture, path) != 0) {
+                err = -1;
+                break;
+            }
+
+            if (strcmp(type, "gesture") == 0) {
+                memset(&gesture, 0, sizeof(gesture));
+                gesture.active = true;
+                gesture.line_no = line_no;
+                section = SECTION_GESTURE;
+                continue;
+            }
+
+            if (strcmp(type, "combo") == 0) {
+                memset(&combo, 0, sizeof(combo));
+                combo.active = true;
+                combo.line_no = line_no;
+                section = SECTION_COMBO;
+                continue;
+            }
+
+            if (strcmp(type, "feedback") == 0 && name == NULL) {
+                section = SECTION_FEEDBACK;
+                continue;
+            }
+
+            if (strcmp(type, "midi") == 0 && name == NULL) {
+                section = SECTION_MIDI;
+                continue;
+            }
+
+            if (strcmp(type, "leds") == 0 && name == NULL) {
+                section = SECTION_LEDS;
+                continue;
+            }
+
+            if (strcmp(type, "buttons") == 0 && name == NULL) {
+                section = SECTION_BUTTONS;
+                continue;
+            }
+
+            if (strcmp(type, "layer") == 0) {
+                if (keymap->num_layers == KEYMAP_MAX_LAYERS) {
+                    fprintf(stderr, "keymap: %s:%d: too many layers\n", path, line_no);
+                    err = -1;
+                    break;
+                }
+                target = alloc_keymap();
+                if (target == NULL) {
+                    err = -1;
+                    break;
+                }
+                layer_switch = &keymap->layer_switches[keymap->num_layer_switches++];
+                layer_switch->layer = keymap->num_layers;
+                layer_switch->mode = LAYER_MOMENTARY;
+                keymap->layers[keymap->num_layers++] = target;
+                section = SECTION_LAYER;
+                continue;
+            }
+
+            if (name == NULL) {
+                fprintf(stderr, "keymap: %s:%d: section [%s] needs a control name\n", path, line_no, type);
+                err = -1;
+                break;
+            }
+
+            section = SECTION_NONE;
+            if (has_section(target, type, name)) {
+                fprintf(stderr, "keymap: %s:%d: duplicate section [%s %s]\n", path, line_no, type, name);
+                err = -1;
+                break;
+            }
+
+            if (strcmp(type, "selector") == 0) {
+                for (size_t i = 0; i < NUM_SELECTOR_CONTROLS; i++) {
+                    if (strcmp(selector_controls[i].name, name) == 0) {
+                        selector_control = &selector_controls[i];
+                        selector = &target->selectors[target->num_selectors++];
+                        selector->id = selector_control->id;
+                        selector->byte = selector_control->byte;
+                        selector->mask = selector_control->mask;
+                        selector->state_count = selector_control->state_count;
+                        selector->states = (selector_state_t *)calloc(selector_control->state_count, sizeof(selector_state_t));
+                        if (selector->states == NULL) {
+                            err = -1;
+                            break;
+                        }
+                        for (int j = 0; j < selector_control->state_count; j++) {
+                            selector->states[j].id = selector_control->state_ids[j];
+                            selector->states[j].value = selector_control->state_values[j];
+                        }
+                        keymap_index_selector(selector);
+                        if (selector->id == SLIP) {
+                            target->slip_states = selector->states;
+                            target->num_slip_states = selector->state_count;
+                        }
+                        section = SECTION_SELECTOR;
+                        break;
+                    }
+                }
+            } else if (strcmp(type, "encoder") == 0) {
+                for (size_t i = 0; i < NUM_ENCODER_CONTROLS; i++) {
+                    if (strcmp(encoder_controls[i].name, name) == 0) {
+                        encoder = &target->encoders[target->num_encoders++];
+                        encoder->id = encoder_controls[i].id;
+                        encoder->byte = encoder_controls[i].byte;
+                        encoder->left_id = encoder_controls[i].left_id;
+                        encoder->right_id = encoder_controls[i].right_id;
+                        section = SECTION_ENCODER;
+                        break;
+                    }
+                }
+            } else if (strcmp(type, "jog") == 0) {
+                for (size_t i = 0; i < NUM_JOG_CONTROLS; i++) {
+                    if (strcmp(jog_controls[i].name, name) == 0) {
+                        jog = &target->jogs[target->num_jogs++];
+                        jog->id = jog_controls[i].id;
+                        jog->byte = jog_controls[i].byte;
+                        section = SECTION_JOG;
+                        break;
+                    }
+                }
+            }
+
+            if (err == 0 && section == SECTION_NONE) {
+                fprintf(stderr, "keymap: %s:%d: unknown section [%s %s]\n", path, line_no, type, name);
+                err = -1;
+            }
+            continue;
+        }
+
+        /* key = value */
+        char* eq = strchr(str, '=');
+        if (eq == NULL) {
+            fprintf(stderr, "keymap: %s:%d: expected 'name = key'\n", path, line_no);
+            err = -1;
+            break;
+        }
+        *eq = '\0';
+        char* key = trim(str);
+        char* value = trim(eq + 1);
+
+        if (section == SECTION_COMBO) {
+            if (strcmp(key, "keys") == 0 && parse_combo_keys(&combo, value) == 0) {
+                /* parsed */
+            } else if (strcmp(key, "exact") == 0) {
+                combo.exact = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+            } else if (strcmp(key, "hold") == 0) {
+                combo.hold_ms = (uint32_t)strtoul(value, NULL, 10);
+            } else if (strcmp(key, "key") == 0 && (combo.keycode = keymap_keycode_from_name(value)) > 0) {
+                /* parsed */
+            } else {
+                fprintf(stderr, "keymap: %s:%d: invalid combo setting '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        if (section == SECTION_GESTURE) {
+            if (parse_gesture_setting(&gesture, key, value) != 0) {
+                fprintf(stderr, "keymap: %s:%d: invalid gesture setting '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        if (section == SECTION_FEEDBACK) {
+            if (parse_feedback(keymap, key, value) != 0) {
+                fprintf(stderr, "keymap: %s:%d: invalid feedback '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        /* like LED bindings, the MIDI map is for the whole keymap */
+        if (section == SECTION_MIDI) {
+            if (keymap->midi == NULL && (keymap->midi = midi_map_alloc()) == NULL) {
+                err = -1;
+                break;
+            }
+            if (midi_map_parse(keymap->midi, key, value) != 0) {
+                fprintf(stderr, "keymap: %s:%d: invalid MIDI mapping '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        /* LED bindings apply to the whole keymap, like combos */
+        if (section == SECTION_LEDS) {
+            if (parse_led_binding(keymap, key, value) != 0) {
+                fprintf(stderr, "keymap: %s:%d: invalid LED binding '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        if (section == SECTION_LAYER) {
+            const button_control_t* control;
+            if (strcmp(key, "switch") == 0 && (control = find_button_control(value)) != NULL) {
+                layer_switch->byte = control->byte;
+                layer_switch->bit = control->bit;
+            } else if (strcmp(key, "mode") == 0 && strcmp(value, "momentary") == 0) {
+                layer_switch->mode = LAYER_MOMENTARY;
+            } else if (strcmp(key, "mode") == 0 && strcmp(value, "latched") == 0) {
+                layer_switch->mode = LAYER_LATCHED;
+            } else {
+                fprintf(stderr, "keymap: %s:%d: invalid layer setting '%s = %s'\n", path, line_no, key, value);
+                err = -1;
+            }
+            continue;
+        }
+
+        int keycode = parse_keycode(path, line_no, value);
+        if (keycode < 0) {
+            err = -1;
+            break;
+        }
+
+        bool found = false;
+        switch (section) {
+        case SECTION_BUTTONS:
+            for (size_t i = 0; i < NUM_BUTTON_CONTROLS; i++) {
+                if (strcmp(button_controls[i].name, key) == 0) {
+                    if (has_button(target, button_controls[i].id)) {
+                        fprintf(stderr, "keymap: %s:%d: '%s' bound twice\n", path, line_no, key);
+                        err = -1;
+                    }
+                    found = true;
+                    if (err != 0) {
+                        break;
+                    }
+                    button_def_t* button = &target->buttons[target->num_buttons++];
+                    button->id = button_controls[i].id;
+                    button->byte = button_controls[i].byte;
+                    button->bit = button_controls[i].bit;
+                    button->keycode = keycode;
+                    break;
+                }
+            }
+            break;
+        case SECTION_SELECTOR:
+            for (int j = 0; j < selector->state_count; j++) {
+                if (strcmp(selector_control->state_names[j], key) == 0) {
+                    selector->states[j].as_button = (keycode != 0);
+                    selector->states[j].keycode = keycode;
+                    found = true;
+                    break;
+                }
+            }
+            break;
+        case SECTION_ENCODER:
+            if (strcmp(key, "left") == 0) {
+                encoder->left_keycode = keycode;
+                found = true;
+            } else if (strcmp(key, "right") == 0) {
+                encoder->right_keycode = keycode;
+                found = true;
+            }
+            encoder->dir_as_button = (encoder->left_keycode != 0 || encoder->right_keycode != 0);
+            break;
+        case SECTION_JOG:
+            if (strcmp(key, "button") == 0) {
+                jog->button_keycode = keycode;
+                found = true;
+            } else if (strcmp(key, "left") == 0) {
+                jog->left_keycode = keycode;
+                found = true;
+            } else if (strcmp(key, "right") == 0) {
+                jog->right_keycode = keycode;
+                found = true;
+            }
+            jog->dir_as_button = (jog->left_keycode != 0 || jog->right_keycode != 0);
+            break;
+        default:
+            fprintf(stderr, "keymap: %s:%d: binding outside of a section\n", path, line_no);
+            err = -1;
+            continue;
+        }
+
+        if (!found) {
+            fprintf(stderr, "keymap: %s:%d: unknown control '%s'\n", path, line_no, key);
+            err = -1;
+        }
+    }
+
+    fclose(fp);
+
+    if (err == 0) {
+        err = flush_combo(keymap, &combo, path);
+    }
+    if (err == 0) {
+        err = flush_gesture(keymap, &gesture, path);
+    }
+    if (err == 0) {
+        err = finish_layers(keymap, path);
+    }
+
+    if (err != 0) {
+        keymap_free(keymap);
+        return NULL;
+    }
+
+    PRINT("keymap: loaded %s: %d buttons, %d selectors, %d encoders, %d jogs, %d layers\n", path,
+          keymap->num_buttons, keymap->num_selectors, keymap->num_encoders, keymap->num_jogs,
+          keymap->num_layers);
+
+    return keymap;
+}
+
+/*
+ * Watch the directory holding the keymap file rather than the file itself,
+ * so that editors which save by writing a new file and renaming it over the
+ * old one are picked up too.
+ */
+int keymap_watch_init(const char* path) {
+    char dir[PATH_MAX];
+    strncpy(dir, path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "keymap: inotify_init1 failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (inotify_add_watch(fd, dirname(dir), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        fprintf(stderr, "keymap: Error watching %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* drain pending inotify events, true if any of them touched the keymap file */
+bool keymap_watch_changed(int watch_fd, const char* path) {
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    char name[PATH_MAX];
+    bool changed = false;
+    ssize_t len;
+
+    strncpy(name, path, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    const char* base = basename(name);
+
+    while ((len = read(watch_fd, buf, sizeof(buf))) > 0) {
+        for (char* ptr = buf; ptr < buf + len; ) {
+            const struct inotify_event* event = (const struct inotify_event *)ptr;
+            if (event->len > 0 && strcmp(event->name, base) == 0) {
+                changed = true;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  Linux key code names for CDJ3K subucom keymap files
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <linux/input.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "keymap.h"
+
+#define KEY_NAME(x) { #x, KEY_##x }
+
+typedef struct key_name {
+    const char *name;
+    int keycode;
+} key_name_t;
+
+static const key_name_t key_names[] = {
+    KEY_NAME(ESC),
+    KEY_NAME(1),
+    KEY_NAME(2),
+    KEY_NAME(3),
+    KEY_NAME(4),
+    KEY_NAME(5),
+    KEY_NAME(6),
+    KEY_NAME(7),
+    KEY_NAME(8),
+    KEY_NAME(9),
+    KEY_NAME(0),
+    KEY_NAME(MINUS),
+    KEY_NAME(EQUAL),
+    KEY_NAME(BACKSPACE),
+    KEY_NAME(TAB),
+    KEY_NAME(Q),
+    KEY_NAME(W),
+    KEY_NAME(E),
+    KEY_NAME(R),
+    KEY_NAME(T),
+    KEY_NAME(Y),
+    KEY_NAME(U),
+    KEY_NAME(I),
+    KEY_NAME(O),
+    KEY_NAME(P),
+    KEY_NAME(LEFTBRACE),
+    KEY_NAME(RIGHTBRACE),
+    KEY_NAME(ENTER),
+    KEY_NAME(LEFTCTRL),
+    KEY_NAME(A),
+    KEY_NAME(S),
+    KEY_NAME(D),
+    KEY_NAME(F),
+    KEY_NAME(G),
+    KEY_NAME(H),
+    KEY_NAME(J),
+    KEY_NAME(K),
+    KEY_NAME(L),
+    KEY_NAME(SEMICOLON),
+    KEY_NAME(APOSTROPHE),
+    KEY_NAME(GRAVE),
+    KEY_NAME(LEFTSHIFT),
+    KEY_NAME(BACKSLASH),
+    KEY_NAME(Z),
+    KEY_NAME(X),
+    KEY_NAME(C),
+    KEY_NAME(V),
+    KEY_NAME(B),
+    KEY_NAME(N),
+    KEY_NAME(M),
+    KEY_NAME(COMMA),
+    KEY_NAME(DOT),
+    KEY_NAME(SLASH),
+    KEY_NAME(RIGHTSHIFT),
+    KEY_NAME(KPASTERISK),
+    KEY_NAME(LEFTALT),
+    KEY_NAME(SPACE),
+    KEY_NAME(CAPSLOCK),
+    KEY_NAME(F1),
+    KEY_NAME(F2),
+    KEY_NAME(F3),
+    KEY_NAME(F4),
+    KEY_NAME(F5),
+    KEY_NAME(F6),
+    KEY_NAME(F7),
+    KEY_NAME(F8),
+    KEY_NAME(F9),
+    KEY_NAME(F10),
+    KEY_NAME(NUMLOCK),
+    KEY_NAME(SCROLLLOCK),
+    KEY_NAME(KP7),
+    KEY_NAME(KP8),
+    KEY_NAME(KP9),
+    KEY_NAME(KPMINUS),
+    KEY_NAME(KP4),
+    KEY_NAME(KP5),
+    KEY_NAME(KP6),
+    KEY_NAME(KPPLUS),
+    KEY_NAME(KP1),
+    KEY_NAME(KP2),
+    KEY_NAME(KP3),
+    KEY_NAME(KP0),
+    KEY_NAME(KPDOT),
+    KEY_NAME(ZENKAKUHANKAKU),
+    KEY_NAME(102ND),
+    KEY_NAME(F11),
+    KEY_NAME(F12),
+    KEY_NAME(RO),
+    KEY_NAME(KATAKANA),
+    KEY_NAME(HIRAGANA),
+    KEY_NAME(HENKAN),
+    KEY_NAME(KATAKANAHIRAGANA),
+    KEY_NAME(MUHENKAN),
+    KEY_NAME(KPJPCOMMA),
+    KEY_NAME(KPENTER),
+    KEY_NAME(RIGHTCTRL),
+    KEY_NAME(KPSLASH),
+    KEY_NAME(SYSRQ),
+    KEY_NAME(RIGHTALT),
+    KEY_NAME(LINEFEED),
+    KEY_NAME(HOME),
+    KEY_NAME(UP),
+    KEY_NAME(PAGEUP),
+    KEY_NAME(LEFT),
+    KEY_NAME(RIGHT),
+    KEY_NAME(END),
+    KEY_NAME(DOWN),
+    KEY_NAME(PAGEDOWN),
+    KEY_NAME(INSERT),
+    KEY_NAME(DELETE),
+    KEY_NAME(MACRO),
+    KEY_NAME(MUTE),
+    KEY_NAME(VOLUMEDOWN),
+    KEY_NAME(VOLUMEUP),
+    KEY_NAME(POWER),
+    KEY_NAME(KPEQUAL),
+    KEY_NAME(KPPLUSMINUS),
+    KEY_NAME(PAUSE),
+    KEY_NAME(SCALE),
+    KEY_NAME(KPCOMMA),
+    KEY_NAME(HANGEUL),
+    KEY_NAME(HANJA),
+    KEY_NAME(YEN),
+    KEY_NAME(LEFTMETA),
+    KEY_NAME(RIGHTMETA),
+    KEY_NAME(COMPOSE),
+    KEY_NAME(STOP),
+    KEY_NAME(AGAIN),
+    KEY_NAME(PROPS),
+    KEY_NAME(UNDO),
+    KEY_NAME(FRONT),
+    KEY_NAME(COPY),
+    KEY_NAME(OPEN),
+    KEY_NAME(PASTE),
+    KEY_NAME(FIND),
+    KEY_NAME(CUT),
+    KEY_NAME(HELP),
+    KEY_NAME(MENU),
+    KEY_NAME(CALC),
+    KEY_NAME(SETUP),
+    KEY_NAME(SLEEP),
+    KEY_NAME(WAKEUP),
+    KEY_NAME(FILE),
+    KEY_NAME(SENDFILE),
+    KEY_NAME(DELETEFILE),
+    KEY_NAME(XFER),
+    KEY_NAME(PROG1),
+    KEY_NAME(PROG2),
+    KEY_NAME(WWW),
+    KEY_NAME(MSDOS),
+    KEY_NAME(COFFEE),
+    KEY_NAME(ROTATE_DISPLAY),
+    KEY_NAME(CYCLEWINDOWS),
+    KEY_NAME(MAIL),
+    KEY_NAME(BOOKMARKS),
+    KEY_NAME(COMPUTER),
+    KEY_NAME(BACK),
+    KEY_NAME(FORWARD),
+    KEY_NAME(CLOSECD),
+    KEY_NAME(EJECTCD),
+    KEY_NAME(EJECTCLOSECD),
+    KEY_NAME(NEXTSONG),
+    KEY_NAME(PLAYPAUSE),
+    KEY_NAME(PREVIOUSSONG),
+    KEY_NAME(STOPCD),
+    KEY_NAME(RECORD),
+    KEY_NAME(REWIND),
+    KEY_NAME(PHONE),
+    KEY_NAME(ISO),
+    KEY_NAME(CONFIG),
+    KEY_NAME(HOMEPAGE),
+    KEY_NAME(REFRESH),
+    KEY_NAME(EXIT),
+    KEY_NAME(MOVE),
+    KEY_NAME(EDIT),
+    KEY_NAME(SCROLLUP),
+    KEY_NAME(SCROLLDOWN),
+    KEY_NAME(KPLEFTPAREN),
+    KEY_NAME(KPRIGHTPAREN),
+    KEY_NAME(NEW),
+    KEY_NAME(REDO),
+    KEY_NAME(F13),
+    KEY_NAME(F14),
+    KEY_NAME(F15),
+    KEY_NAME(F16),
+    KEY_NAME(F17),
+    KEY_NAME(F18),
+    KEY_NAME(F19),
+    KEY_NAME(F20),
+    KEY_NAME(F21),
+    KEY_NAME(F22),
+    KEY_NAME(F23),
+    KEY_NAME(F24),
+    KEY_NAME(PLAYCD),
+    KEY_NAME(PAUSECD),
+    KEY_NAME(PROG3),
+    KEY_NAME(PROG4),
+    KEY_NAME(ALL_APPLICATIONS),
+    KEY_NAME(SUSPEND),
+    KEY_NAME(CLOSE),
+    KEY_NAME(PLAY),
+    KEY_NAME(FASTFORWARD),
+    KEY_NAME(BASSBOOST),
+    KEY_NAME(PRINT),
+    KEY_NAME(HP),
+    KEY_NAME(CAMERA),
+    KEY_NAME(SOUND),
+    KEY_NAME(QUESTION),
+    KEY_NAME(EMAIL),
+    KEY_NAME(CHAT),
+    KEY_NAME(SEARCH),
+    KEY_NAME(CONNECT),
+    KEY_NAME(FINANCE),
+    KEY_NAME(SPORT),
+    KEY_NAME(SHOP),
+    KEY_NAME(ALTERASE),
+    KEY_NAME(CANCEL),
+    KEY_NAME(BRIGHTNESSDOWN),
+    KEY_NAME(BRIGHTNESSUP),
+    KEY_NAME(MEDIA),
+    KEY_NAME(SWITCHVIDEOMODE),
+    KEY_NAME(KBDILLUMTOGGLE),
+    KEY_NAME(KBDILLUMDOWN),
+    KEY_NAME(KBDILLUMUP),
+    KEY_NAME(SEND),
+    KEY_NAME(REPLY),
+    KEY_NAME(FORWARDMAIL),
+    KEY_NAME(SAVE),
+    KEY_NAME(DOCUMENTS),
+    KEY_NAME(BATTERY),
+    KEY_NAME(BLUETOOTH),
+    KEY_NAME(WLAN),
+    KEY_NAME(UWB),
+    KEY_NAME(UNKNOWN),
+    KEY_NAME(VIDEO_NEXT),
+    KEY_NAME(VIDEO_PREV),
+    KEY_NAME(BRIGHTNESS_CYCLE),
+    KEY_NAME(BRIGHTNESS_AUTO),
+    KEY_NAME(DISPLAY_OFF),
+    KEY_NAME(WWAN),
+    KEY_NAME(RFKILL),
+    KEY_NAME(MICMUTE),
+};
+
+#define LED_NAME(x) { #x, LED_##x }
+
+static const key_name_t led_names[] = {
+    LED_NAME(NUML),
+    LED_NAME(CAPSL),
+    LED_NAME(SCROLLL),
+    LED_NAME(COMPOSE),
+    LED_NAME(KANA),
+    LED_NAME(SLEEP),
+    LED_NAME(SUSPEND),
+    LED_NAME(MUTE),
+    LED_NAME(MISC),
+    LED_NAME(MAIL),
+    LED_NAME(CHARGING),
+};
+
+/*
+ * Resolve a key name as used in keymap files. Accepts "KEY_ENTER",
+ * "ENTER" or a plain decimal code from KEY_ESC to KEYMAP_MAX_KEYCODE.
+ * "KEY_1" is the key labelled 1, "1" is code 1. Returns -1 for unknown
+ * names.
+ */
+int keymap_keycode_from_name(const char *name) {
+    if (name[0] >= '0' && name[0] <= '9') {
+        char *end;
+        long code = strtol(name, &end, 10);
+        if (*end != '\0' || code < KEY_ESC || code > KEYMAP_MAX_KEYCODE) {
+            return -1;
+        }
+        return (int)code;
+    }
+
+    if (strncmp(name, "KEY_", 4) == 0) {
+        name += 4;
+    }
+
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (strcmp(key_names[i].name, name) == 0) {
+            return key_names[i].keycode;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Resolve an evdev LED name, "LED_MISC", "MISC" or a decimal code up to
+ * LED_MAX, the codes without a name being free for vendor use. Returns -1
+ * for unknown names.
+ */
+int keymap_led_code_from_name(const char *name) {
+    if (strncmp(name, "LED_", 4) == 0) {
+        name += 4;
+    }
+
+    if (name[0] >= '0' && name[0] <= '9') {
+        char *end;
+        long code = strtol(name, &end, 10);
+        if (*end != '\0' || code < 0 || code > LED_MAX) {
+            return -1;
+        }
+        return (int)code;
+    }
+
+    for (size_t i = 0; i < sizeof(led_names) / sizeof(led_names[0]); i++) {
+        if (strcmp(led_names[i].name, name) == 0) {
+            return led_names[i].keycode;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom frame layouts per firmware revision
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stddef.h>
+
+#include "layout.h"
+
+const subucom_layout_t subucom_layout_reference = {
+    0, 0, 0xFF, "reference (doc/subucom_fields.js)", NULL
+};
+
+/*
+ * Revisions known to use the reference layout, or a src table of their
+ * own, terminated by an entry without a name. Add units here as their
+ * firmware gets characterized.
+ */
+static const subucom_layout_t layouts[] = {
+    { 0 },
+};
+
+/* NULL for a revision not in the table */
+const subucom_layout_t* subucom_layout_find(uint8_t major, uint8_t minor) {
+    for (size_t i = 0; layouts[i].name != NULL; i++) {
+        if (layouts[i].major == major && minor >= layouts[i].minor_min && minor <= layouts[i].minor_max) {
+            return &layouts[i];
+        }
+    }
+    return NULL;
+}
+
+/* number of revisions characterized so far */
+int subucom_layout_count(void) {
+    return sizeof(layouts) / sizeof(layouts[0]) - 1;
+}
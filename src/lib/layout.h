@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom frame layouts per firmware revision
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __LAYOUT_H_
+#define __LAYOUT_H_
+
+#include <stdint.h>
+
+/*
+ * Input frame layout of a range of subucom firmware revisions. Keymaps and
+ * everything else in this package use the reference layout documented in
+ * doc/subucom_fields.js. A revision that moves fields has a src table, src[i]
+ * being the byte of its frame that holds reference byte i; frames are
+ * rearranged into the reference layout right after the CRC check, and
+ * given the CRC of the rearranged frame.
+ */
+typedef struct subucom_layout {
+    uint8_t         major;
+    uint8_t         minor_min;
+    uint8_t         minor_max;
+    const char*     name;
+    const uint8_t*  src;        /* NULL for the reference layout */
+} subucom_layout_t;
+
+extern const subucom_layout_t subucom_layout_reference;
+
+const subucom_layout_t* subucom_layout_find(uint8_t major, uint8_t minor);
+int                     subucom_layout_count(void);
+
+#endif /* __LAYOUT_H_ */
@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED animations
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "led_anim.h"
+#include "crc16.h"
+
+void led_timeline_init(led_timeline_t* tl, uint16_t step_ms, uint32_t length_ms, bool loop) {
+    memset(tl, 0, sizeof(*tl));
+    tl->step_ms = (step_ms > 0) ? step_ms : 1;
+    tl->length_ms = length_ms;
+    tl->loop = loop;
+    tl->timer_fd = -1;
+}
+
+/* returns the index of the new animation in tl->anims */
+int led_timeline_add(led_timeline_t* tl, led_effect_t effect, const uint8_t* leds, uint8_t num_leds,
+                     uint16_t period_ms, uint16_t offset_ms, uint8_t level) {
+    if (tl->num_anims == LED_ANIM_MAX || num_leds == 0 || num_leds > LED_ANIM_MAX_LEDS || period_ms == 0) {
+        fprintf(stderr, "led_anim: Invalid animation\n");
+        return -1;
+    }
+
+    led_anim_t* anim = &tl->anims[tl->num_anims++];
+    anim->effect = effect;
+    memcpy(anim->leds, leds, num_leds);
+    anim->num_leds = num_leds;
+    anim->group = 1;
+    anim->period_ms = period_ms;
+    anim->offset_ms = offset_ms;
+    anim->level = (level > LED_ANIM_MAX_LEVEL) ? LED_ANIM_MAX_LEVEL : level;
+
+    return tl->num_anims - 1;
+}
+
+/* brightness step of LED i of anim at t_ms */
+static uint8_t anim_level(const led_anim_t* anim, int i, uint32_t t_ms) {
+    uint32_t t = t_ms + anim->offset_ms;
+    uint32_t phase = t % anim->period_ms;
+
+    switch (anim->effect) {
+    case LED_BLINK:
+        return (phase < anim->period_ms / 2u) ? anim->level : 0;
+    case LED_PULSE: {
+        uint32_t half = anim->period_ms / 2u;
+        uint32_t up = (phase < half) ? phase : anim->period_ms - phase;
+        return (uint8_t)((anim->level * up + half / 2) / (half ? half : 1));
+    }
+    case LED_CHASE: {
+        int groups = (anim->num_leds + anim->group - 1) / anim->group;
+        return ((int)(phase * groups / anim->period_ms) == i / anim->group) ? anim->level : 0;
+    }
+    case LED_FADE_IN:
+        return (t >= anim->period_ms) ? anim->level : (uint8_t)(anim->level * t / anim->period_ms);
+    case LED_FADE_OUT:
+        return (t >= anim->period_ms) ? 0 : (uint8_t)(anim->level * (anim->period_ms - t) / anim->period_ms);
+    }
+    return 0;
+}
+
+/* brightness step to the field value, dim/bright fields only have two levels */
+static uint8_t field_level(led_id_t led, uint8_t step) {
+    switch (led_defs[led].width) {
+    case 8:
+        return led_brightness(step);
+    case 2:
+        return (step == 0) ? 0x0 : (step <= LED_ANIM_MAX_LEVEL / 2) ? 0x1 : 0x3;
+    default:
+        return (step >= LED_ANIM_MAX_LEVEL / 2) ? 1 : 0;
+    }
+}
+
+static void draw_frame(const led_timeline_t* tl, uint8_t* frame, uint32_t t_ms) {
+    int16_t levels[NUM_LEDS];
+    for (int i = 0; i < NUM_LEDS; i++) {
+        levels[i] = -1;
+    }
+
+    for (int a = 0; a < tl->num_anims; a++) {
+        const led_anim_t* anim = &tl->anims[a];
+        for (int i = 0; i < anim->num_leds; i++) {
+            uint8_t level = anim_level(anim, i, t_ms);
+            if (level > levels[anim->leds[i]]) {
+                levels[anim->leds[i]] = level;
+            }
+        }
+    }
+
+    memset(frame, 0, SUBUCOM_BUFSIZE);
+    memcpy(frame, tl->base, LED_FRAME_SIZE);
+    for (int i = 0; i < NUM_LEDS; i++) {
+        if (levels[i] >= 0) {
+            led_set_level(frame, i, field_level(i, levels[i]));
+        }
+    }
+
+    uint16_t crc16 = crc16_x25_calc(frame, LED_FRAME_SIZE);
+    frame[SUBUCOM_BUFSIZE-2] = (crc16 & 0xFF);
+    frame[SUBUCOM_BUFSIZE-1] = (crc16 >> 8);
+}
+
+/* precompute every frame of the timeline */
+int led_timeline_compile(led_timeline_t* tl) {
+    uint32_t num_frames = (tl->length_ms + tl->step_ms - 1) / tl->step_ms;
+    if (num_frames == 0 || num_frames > LED_ANIM_MAX_FRAMES) {
+        fprintf(stderr, "led_anim: Timeline needs 1-%d frames, not %u\n", LED_ANIM_MAX_FRAMES, num_frames);
+        return -1;
+    }
+
+    free(tl->frames);
+    free(tl->changed);
+    tl->frames = calloc(num_frames, SUBUCOM_BUFSIZE);
+    tl->changed = calloc(num_frames, sizeof(bool));
+    if (tl->frames == NULL || tl->changed == NULL) {
+        return -1;
+    }
+    tl->num_frames = num_frames;
+
+    for (uint32_t f = 0; f < num_frames; f++) {
+        draw_frame(tl, tl->frames[f], f * tl->step_ms);
+    }
+
+    for (uint32_t f = 0; f < num_frames; f++) {
+        uint32_t prev = (f > 0) ? f - 1 : num_frames - 1;
+        tl->changed[f] = (memcmp(tl->frames[f], tl->frames[prev], SUBUCOM_BUFSIZE) != 0);
+    }
+
+    return 0;
+}
+
+/* start playback, returns the timer fd to wait on */
+int led_timeline_start(led_timeline_t* tl) {
+    if (tl->timer_fd < 0) {
+        tl->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (tl->timer_fd < 0) {
+            fprintf(stderr, "led_anim: timerfd_create failed: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+
+    struct itimerspec its = {
+        .it_interval = { .tv_sec = tl->step_ms / 1000, .tv_nsec = (tl->step_ms % 1000) * 1000000L },
+        .it_value = { .tv_sec = tl->step_ms / 1000, .tv_nsec = (tl->step_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(tl->timer_fd, 0, &its, NULL);
+
+    tl->pos = 0;
+    tl->done = false;
+
+    return tl->timer_fd;
+}
+
+/*
+ * Wait for the next step (blocking unless the timer fd is polled first) and
+ * return the frame to send, or NULL when it equals the frame already sent.
+ * Missed steps are skipped rather than played late.
+ */
+const uint8_t* led_timeline_advance(led_timeline_t* tl) {
+    uint64_t expirations = 0;
+    if (tl->done || read(tl->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        return NULL;
+    }
+
+    uint32_t prev = tl->pos;
+    uint32_t pos = prev + expirations;
+    if (pos >= tl->num_frames) {
+        if (tl->loop) {
+            pos %= tl->num_frames;
+        } else {
+            pos = tl->num_frames - 1;
+            tl->done = true;
+        }
+    }
+    tl->pos = pos;
+
+    bool changed = (expirations == 1) ? tl->changed[pos]
+                                      : (memcmp(tl->frames[pos], tl->frames[prev], SUBUCOM_BUFSIZE) != 0);
+    return changed ? tl->frames[pos] : NULL;
+}
+
+void led_timeline_free(led_timeline_t* tl) {
+    if (tl->timer_fd >= 0) {
+        close(tl->timer_fd);
+        tl->timer_fd = -1;
+    }
+    free(tl->frames);
+    free(tl->changed);
+    tl->frames = NULL;
+    tl->changed = NULL;
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED animations
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __LED_ANIM_H_
+#define __LED_ANIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "leds.h"
+#include "subucom.h"
+
+#define LED_ANIM_MAX         8
+#define LED_ANIM_MAX_LEDS    NUM_LEDS
+#define LED_ANIM_MAX_FRAMES  1024
+#define LED_ANIM_MAX_LEVEL   8      /* brightness steps, see led_brightness() */
+
+typedef enum led_effect {
+    LED_BLINK,      /* on for the first half of the period */
+    LED_PULSE,      /* up and down again once per period */
+    LED_CHASE,      /* one group of LEDs after another */
+    LED_FADE_IN,    /* up over the period, then held */
+    LED_FADE_OUT    /* down over the period, then off */
+} led_effect_t;
+
+typedef struct led_anim {
+    led_effect_t effect;
+    uint8_t      leds[LED_ANIM_MAX_LEDS];
+    uint8_t      num_leds;
+    uint8_t      group;         /* LEDs lit together by LED_CHASE */
+    uint16_t     period_ms;
+    uint16_t     offset_ms;     /* phase */
+    uint8_t      level;         /* peak, 0-LED_ANIM_MAX_LEVEL */
+} led_anim_t;
+
+/*
+ * A timeline of animations drawn over a static base frame. Where
+ * animations overlap an LED gets the brightest of them. The whole timeline
+ * is compiled into ready to send frames, so playing it back costs a timer
+ * expiry and at most one write per step.
+ */
+typedef struct led_timeline {
+    uint8_t     base[LED_FRAME_SIZE];
+    led_anim_t  anims[LED_ANIM_MAX];
+    uint8_t     num_anims;
+    uint16_t    step_ms;
+    uint32_t    length_ms;
+    bool        loop;
+
+    uint8_t   (*frames)[SUBUCOM_BUFSIZE];   /* CRC included */
+    bool*       changed;                    /* frame differs from the one before */
+    uint16_t    num_frames;
+    uint16_t    pos;
+    bool        done;
+    int         timer_fd;
+} led_timeline_t;
+
+void           led_timeline_init(led_timeline_t* tl, uint16_t step_ms, uint32_t length_ms, bool loop);
+int            led_timeline_add(led_timeline_t* tl, led_effect_t effect, const uint8_t* leds, uint8_t num_leds,
+                                uint16_t period_ms, uint16_t offset_ms, uint8_t level);
+int            led_timeline_compile(led_timeline_t* tl);
+int            led_timeline_start(led_timeline_t* tl);
+const uint8_t* led_timeline_advance(led_timeline_t* tl);
+void           led_timeline_free(led_timeline_t* tl);
+
+#endif /* __LED_ANIM_H_ */
@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED control socket
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "led_server.h"
+
+static void drop_client(led_client_t* client) {
+    subucom_unwatch_fd(client->server->subucom, client->fd);
+    close(client->fd);
+    if (client->frame != NULL) {
+        munmap((void *)client->frame, LED_FRAME_SIZE);
+    }
+    client->fd = -1;
+    client->frame = NULL;
+}
+
+static int map_frame(led_client_t* client, int memfd) {
+    /* a frame that could shrink would SIGBUS the read on the next doorbell */
+    int seals = fcntl(memfd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+        fprintf(stderr, "led_server: LED frame memfd not sealed against shrinking\n");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(memfd, &st) != 0 || st.st_size < LED_FRAME_SIZE) {
+        fprintf(stderr, "led_server: LED frame memfd too small\n");
+        return -1;
+    }
+
+    void* ptr = mmap(NULL, LED_FRAME_SIZE, PROT_READ, MAP_SHARED, memfd, 0);
+    if (ptr == MAP_FAILED) {
+        fprintf(stderr, "led_server: mmap failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (client->frame != NULL) {
+        munmap((void *)client->frame, LED_FRAME_SIZE);
+    }
+    client->frame = (const uint8_t *)ptr;
+
+    return 0;
+}
+
+static void handle_client(int fd, short revents, void* ctx) {
+    led_client_t* client = (led_client_t *)ctx;
+    subucom_t* subucom = client->server->subucom;
+
+    led_msg_t msg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    struct iovec iov = { .iov_base = &msg, .iov_len = sizeof(msg) };
+    struct msghdr hdr = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof(control.buf),
+    };
+
+    ssize_t len = recvmsg(fd, &hdr, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (len < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (len <= 0) {
+        drop_client(client);
+        return;
+    }
+
+    int memfd = -1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    switch (msg.type) {
+    case LED_MSG_SET:
+        if (len < 2 || msg.count > NUM_LEDS || len < 2 + msg.count * (ssize_t)sizeof(led_msg_pair_t)) {
+            fprintf(stderr, "led_server: Short LED_MSG_SET\n");
+            break;
+        }
+        for (int i = 0; i < msg.count; i++) {
+            if (msg.pairs[i].led < NUM_LEDS) {
+                subucom_set_led(subucom, msg.pairs[i].led, msg.pairs[i].level);
+            }
+        }
+        break;
+    case LED_MSG_FRAME:
+        if (memfd < 0) {
+            fprintf(stderr, "led_server: LED_MSG_FRAME without memfd\n");
+            break;
+        }
+        map_frame(client, memfd);
+        break;
+    case LED_MSG_DOORBELL:
+        if (client->frame != NULL) {
+            /* undocumented bytes of the output frame can crash the player */
+            uint8_t frame[LED_FRAME_SIZE];
+            for (int i = 0; i < LED_FRAME_SIZE; i++) {
+                frame[i] = client->frame[i] & client->server->frame_mask[i];
+            }
+            subucom_set_leds(subucom, frame);
+        }
+        break;
+    default:
+        fprintf(stderr, "led_server: Unknown message type %d\n", msg.type);
+        break;
+    }
+
+    if (memfd >= 0) {
+        close(memfd);
+    }
+}
+
+static void handle_accept(int fd, short revents, void* ctx) {
+    led_server_t* server = (led_server_t *)ctx;
+
+    int client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd < 0) {
+        return;
+    }
+
+    for (int i = 0; i < LED_SERVER_MAX_CLIENTS; i++) {
+        led_client_t* client = &server->clients[i];
+        if (client->fd >= 0) {
+            continue;
+        }
+
+        if (subucom_watch_fd(server->subucom, client_fd, POLLIN, handle_client, client) != 0) {
+            break;
+        }
+        client->fd = client_fd;
+        return;
+    }
+
+    fprintf(stderr, "led_server: Too many clients\n");
+    close(client_fd);
+}
+
+int led_server_init(led_server_t* server, subucom_t* subucom, const char* path) {
+    server->subucom = subucom;
+    for (int i = 0; i < LED_SERVER_MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+        server->clients[i].frame = NULL;
+        server->clients[i].server = server;
+    }
+
+    memset(server->frame_mask, 0, LED_FRAME_SIZE);
+    for (int i = 0; i < NUM_LEDS; i++) {
+        server->frame_mask[led_defs[i].byte] |= ((1u << led_defs[i].width) - 1) << led_defs[i].shift;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "led_server: Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    strcpy(server->path, path);
+
+    server->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->fd < 0) {
+        fprintf(stderr, "led_server: Error creating socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    /* a stale socket from a previous run */
+    unlink(path);
+
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(server->fd, LED_SERVER_MAX_CLIENTS) != 0) {
+        fprintf(stderr, "led_server: Error listening on %s: %s\n", path, strerror(errno));
+        close(server->fd);
+        return -1;
+    }
+
+    if (subucom_watch_fd(subucom, server->fd, POLLIN, handle_accept, server) != 0) {
+        led_server_deinit(server);
+        return -1;
+    }
+
+    return 0;
+}
+
+void led_server_deinit(led_server_t* server) {
+    for (int i = 0; i < LED_SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i].fd >= 0) {
+            drop_client(&server->clients[i]);
+        }
+    }
+
+    subucom_unwatch_fd(server->subucom, server->fd);
+    close(server->fd);
+    unlink(server->path);
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED control socket
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __LED_SERVER_H_
+#define __LED_SERVER_H_
+
+#include <stdint.h>
+#include <sys/un.h>
+
+#include "leds.h"
+#include "subucom.h"
+
+#define LED_SERVER_PATH         "/run/subucom_leds.sock"
+#define LED_SERVER_MAX_CLIENTS  4
+
+/*
+ * Protocol, one SOCK_SEQPACKET message per command:
+ *
+ *   LED_MSG_SET       count (led, level) pairs, see leds.h for the levels
+ *   LED_MSG_FRAME     no payload, carries a memfd of at least LED_FRAME_SIZE
+ *                     bytes as SCM_RIGHTS, sealed with F_SEAL_SHRINK so it
+ *                     can't be truncated under the mapping; it is mapped
+ *                     once and replaces any frame sent before
+ *   LED_MSG_DOORBELL  no payload, the LED bits of the mapped frame are taken
+ *                     over, other bytes of the output frame stay zero
+ *
+ * Commands are applied to the pending LED frame, which goes out at most
+ * once per scan interval.
+ */
+enum led_msg_type {
+    LED_MSG_SET = 1,
+    LED_MSG_FRAME,
+    LED_MSG_DOORBELL,
+};
+
+typedef struct led_msg_pair {
+    uint8_t led;
+    uint8_t level;
+} led_msg_pair_t;
+
+typedef struct led_msg {
+    uint8_t        type;
+    uint8_t        count;
+    led_msg_pair_t pairs[NUM_LEDS];
+} led_msg_t;
+
+struct led_server;
+
+typedef struct led_client {
+    int                fd;
+    const uint8_t*     frame;       /* mapped memfd frame, NULL until sent */
+    struct led_server* server;
+} led_client_t;
+
+typedef struct led_server {
+    int            fd;
+    char           path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    subucom_t*     subucom;
+    led_client_t   clients[LED_SERVER_MAX_CLIENTS];
+    uint8_t        frame_mask[LED_FRAME_SIZE];  /* bits of the LEDs in leds.h */
+} led_server_t;
+
+int  led_server_init(led_server_t* server, subucom_t* subucom, const char* path);
+void led_server_deinit(led_server_t* server);
+
+#endif /* __LED_SERVER_H_ */
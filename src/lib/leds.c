@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED definitions
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <string.h>
+
+#include "leds.h"
+
+const led_def_t led_defs[NUM_LEDS] = {
+#define LED_DEF(name, byte, shift, width) [LED_##name] = { #name, byte, shift, width },
+    SUBUCOM_OUT_FIELDS(LED_DEF)
+#undef LED_DEF
+};
+
+int led_find(const char* name) {
+    for (int i = 0; i < NUM_LEDS; i++) {
+        if (strcmp(led_defs[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void led_set_level(uint8_t* frame, led_id_t led, uint8_t level) {
+    const led_def_t* def = &led_defs[led];
+    uint8_t mask = (uint8_t)(((1u << def->width) - 1) << def->shift);
+
+    frame[def->byte] = (frame[def->byte] & ~mask) | ((level << def->shift) & mask);
+}
+
+uint8_t led_get_level(const uint8_t* frame, led_id_t led) {
+    const led_def_t* def = &led_defs[led];
+    return (frame[def->byte] >> def->shift) & ((1u << def->width) - 1);
+}
+
+/* R/G/B byte for 0-8 brightness steps */
+uint8_t led_brightness(uint8_t steps) {
+    return (steps >= 8) ? 0xFF : (uint8_t)((1u << steps) - 1);
+}
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom LED definitions
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __LEDS_H_
+#define __LEDS_H_
+
+#include <stdint.h>
+
+#include "protocol.h"
+
+/* the LED frame is the output frame without its CRC */
+#define LED_FRAME_SIZE      62
+
+/* LED fields of the output frame, LED_HOTCUE_A_R etc., see doc/subucom_fields.js */
+typedef enum led_id {
+#define LED_ID(name, byte, shift, width) LED_##name,
+    SUBUCOM_OUT_FIELDS(LED_ID)
+#undef LED_ID
+    NUM_LEDS
+} led_id_t;
+
+/*
+ * Field of one LED. Levels are the raw field value: 0/1 for single bit
+ * LEDs, 0-3 for dim/bright LEDs (see README), and 0x00-0xFF for the R/G/B
+ * brightness bytes, where every set bit adds one brightness step.
+ */
+typedef struct led_def {
+    const char *name;
+    uint8_t byte;
+    uint8_t shift;
+    uint8_t width;
+} led_def_t;
+
+extern const led_def_t led_defs[NUM_LEDS];
+
+int     led_find(const char* name);
+void    led_set_level(uint8_t* frame, led_id_t led, uint8_t level);
+uint8_t led_get_level(const uint8_t* frame, led_id_t led);
+uint8_t led_brightness(uint8_t steps);
+
+#endif /* __LEDS_H_ */
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom MIDI output
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "midi.h"
+#include "sink.h"
+#include "subucom.h"
+
+#define NOTE_ON         0x90
+#define CONTROL_CHANGE  0xB0
+
+#define CC_DATA_MSB     6
+#define CC_DATA_LSB     38
+#define CC_NRPN_LSB     98
+#define CC_NRPN_MSB     99
+
+/* the largest value update, an NRPN with its parameter selected */
+#define MAX_VALUE_BYTES 9
+
+static const char* value_names[MIDI_NUM_VALUES] = {
+    [MIDI_TEMPO]   = "tempo",
+    [MIDI_TOUCH_X] = "touch",
+    [MIDI_TOUCH_Y] = NULL,      /* touch + 1 */
+};
+
+midi_map_t* midi_map_alloc(void) {
+    midi_map_t* map = (midi_map_t *)calloc(1, sizeof(midi_map_t));
+    if (map == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < MIDI_NUM_VALUES; i++) {
+        map->params[i] = MIDI_NONE;
+    }
+    map->jog_cc = MIDI_NONE;
+    return map;
+}
+
+static int parse_number(const char* str, long min, long max) {
+    char* end;
+    long val = (str != NULL) ? strtol(str, &end, 10) : -1;
+    if (str == NULL || end == str || *end != '\0' || val < min || val > max) {
+        return -1;
+    }
+    return (int)val;
+}
+
+/*
+ * One [midi] line:
+ *   channel = 1-16
+ *   jog = cc                   relative CC (0-127), MIDI_JOG_CW or _CCW
+ *   tempo = cc                 14 bit CC pair on cc (0-31) and cc + 32
+ *   touch = nrpn               x on NRPN nrpn, y on nrpn + 1
+ *   KEY_NAME = note N | cc N   the keycode as a note or CC (0-127)
+ */
+int midi_map_parse(midi_map_t* map, const char* key, char* value) {
+    if (strcmp(key, "channel") == 0) {
+        int channel = parse_number(value, 1, 16);
+        if (channel < 0) {
+            return -1;
+        }
+        map->channel = channel - 1;
+        return 0;
+    }
+
+    if (strcmp(key, "jog") == 0) {
+        int cc = parse_number(value, 0, 127);
+        if (cc < 0) {
+            return -1;
+        }
+        map->jog_cc = cc;
+        return 0;
+    }
+
+    for (int i = 0; i < MIDI_NUM_VALUES; i++) {
+        if (value_names[i] == NULL || strcmp(value_names[i], key) != 0) {
+            continue;
+        }
+        if (i == MIDI_TOUCH_X) {
+            int nrpn = parse_number(value, 0, 16382);
+            if (nrpn < 0) {
+                return -1;
+            }
+            map->params[MIDI_TOUCH_X] = nrpn;
+            map->params[MIDI_TOUCH_Y] = nrpn + 1;
+        } else {
+            int cc = parse_number(value, 0, 31);
+            if (cc < 0) {
+                return -1;
+            }
+            map->params[i] = cc;
+        }
+        return 0;
+    }
+
+    int code = keymap_keycode_from_name(key);
+    if (code <= 0 || code >= KEY_CNT) {
+        return -1;
+    }
+
+    char* save = NULL;
+    char* type = strtok_r(value, " \t", &save);
+    int number = parse_number(strtok_r(NULL, " \t", &save), 0, 127);
+    if (type == NULL || number < 0) {
+        return -1;
+    }
+
+    if (strcmp(type, "note") == 0) {
+        map->keys[code].type = MIDI_MSG_NOTE;
+    } else if (strcmp(type, "cc") == 0) {
+        map->keys[code].type = MIDI_MSG_CC;
+    } else {
+        return -1;
+    }
+    map->keys[code].number = number;
+
+    return 0;
+}
+
+static const midi_map_t* current_map(const midi_out_t* out) {
+    const keymap_t* keymap = out->subucom->_keymap;
+    return (keymap != NULL) ? keymap->midi : NULL;
+}
+
+/* append a channel message, leaving the status byte out where it repeats */
+static void put(midi_out_t* out, uint8_t status, uint8_t data1, uint8_t data2) {
+    if (status != out->status) {
+        out->buf[out->len++] = status;
+        out->status = status;
+    }
+    out->buf[out->len++] = data1;
+    out->buf[out->len++] = data2;
+}
+
+static void put_value(midi_out_t* out, const midi_map_t* map, int i) {
+    uint8_t status = CONTROL_CHANGE | map->channel;
+    uint16_t param = map->params[i];
+    uint16_t value = out->values[i];
+    uint16_t sent = out->sent[i];
+
+    /* a new MSB resets the LSB on the receiving end, so both go out then */
+    bool send_msb = (sent == MIDI_NONE || (sent >> 7) != (value >> 7));
+
+    if (i == MIDI_TOUCH_X || i == MIDI_TOUCH_Y) {
+        if (out->nrpn != param) {
+            put(out, status, CC_NRPN_MSB, param >> 7);
+            put(out, status, CC_NRPN_LSB, param & 0x7F);
+            out->nrpn = param;
+            send_msb = true;
+        }
+        if (send_msb) {
+            put(out, status, CC_DATA_MSB, value >> 7);
+        }
+        put(out, status, CC_DATA_LSB, value & 0x7F);
+    } else {
+        if (send_msb) {
+            put(out, status, param, value >> 7);
+        }
+        put(out, status, param + 32, value & 0x7F);
+    }
+
+    out->sent[i] = value;
+}
+
+static void state_changed(struct subucom* subucom, uint32_t changed, void* ctx) {
+    midi_out_state((midi_out_t *)ctx, subucom_get_state(subucom, changed));
+}
+
+static int find_virmidi(char* path, size_t size) {
+    FILE* fp = fopen("/proc/asound/cards", "r");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    char line[256];
+    int card = -1;
+    while (card < 0 && fgets(line, sizeof(line), fp) != NULL) {
+        if (strstr(line, "VirMIDI") == NULL || sscanf(line, " %d [", &card) != 1) {
+            card = -1;
+        }
+    }
+    fclose(fp);
+
+    if (card < 0) {
+        return -1;
+    }
+    snprintf(path, size, "/dev/snd/midiC%dD0", card);
+    return 0;
+}
+
+/*
+ * Open the FIFO or rawmidi port at path, "virmidi" for the first ALSA
+ * virtual MIDI card. Continuous controls are followed for the lifetime of
+ * subucom.
+ */
+int midi_out_open(midi_out_t* out, struct subucom* subucom, const char* path) {
+    char virmidi_path[64];
+    if (strcmp(path, "virmidi") == 0) {
+        if (find_virmidi(virmidi_path, sizeof(virmidi_path)) != 0) {
+            fprintf(stderr, "midi: No ALSA virtual MIDI card, is snd-virmidi loaded?\n");
+            return -1;
+        }
+        path = virmidi_path;
+    }
+
+    /* a FIFO opened for reading too never fails for lack of a reader */
+    struct stat st;
+    int flags = (stat(path, &st) == 0 && S_ISFIFO(st.st_mode)) ? O_RDWR : O_WRONLY;
+
+    out->fd = open(path, flags | O_NONBLOCK | O_CLOEXEC);
+    if (out->fd < 0) {
+        fprintf(stderr, "midi: Error opening %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    out->subucom = subucom;
+    out->len = 0;
+    out->status = 0;
+    out->nrpn = MIDI_NONE;
+    memset(out->held, 0, sizeof(out->held));
+    for (int i = 0; i < MIDI_NUM_VALUES; i++) {
+        out->values[i] = MIDI_NONE;
+        out->sent[i] = MIDI_NONE;
+    }
+    out->jog_seq = subucom->seq;
+
+    if (subucom_watch_state(subucom, SUBUCOM_STATE_TEMPO | SUBUCOM_STATE_TOUCH, state_changed, out) != 0) {
+        close(out->fd);
+        return -1;
+    }
+
+    return 0;
+}
+
+void midi_out_close(midi_out_t* out) {
+    close(out->fd);
+}
+
+/*
+ * Encode a key event. A release always ends the message its press started,
+ * even if the keymap changed in between. Returns 1 once encoded and 0 while
+ * out of room, like a sink_write_fn_t.
+ */
+int midi_out_key(midi_out_t* out, int code, int val) {
+    if (code <= 0 || code >= KEY_CNT || val == 2) {
+        return 1;
+    }
+
+    midi_key_t key = out->held[code];
+    if (val == 1) {
+        const midi_map_t* map = current_map(out);
+        if (map == NULL || map->keys[code].type == MIDI_MSG_NONE) {
+            return 1;
+        }
+        key = map->keys[code];
+        key.channel = map->channel;
+    } else if (key.type == MIDI_MSG_NONE) {
+        return 1;
+    }
+
+    if (MIDI_BUF_SIZE - out->len < 3) {
+        midi_out_flush(out);
+        if (MIDI_BUF_SIZE - out->len < 3) {
+            return 0;
+        }
+    }
+
+    uint8_t status = ((key.type == MIDI_MSG_NOTE) ? NOTE_ON : CONTROL_CHANGE) | key.channel;
+    put(out, status, key.number, val ? 127 : 0);
+
+    if (val == 1) {
+        out->held[code] = key;
+    } else {
+        out->held[code].type = MIDI_MSG_NONE;
+    }
+    return 1;
+}
+
+/* keep the latest continuous values, encoded by the next flush */
+void midi_out_state(midi_out_t* out, const subucom_state_t* state) {
+    if (state->valid & SUBUCOM_STATE_TEMPO) {
+        out->values[MIDI_TEMPO] = state->tempo_slider >> 2;
+    }
+    if (state->valid & SUBUCOM_STATE_TOUCH) {
+        out->values[MIDI_TOUCH_X] = state->touch_x & 0x3FFF;
+        out->values[MIDI_TOUCH_Y] = state->touch_y & 0x3FFF;
+    }
+}
+
+/* one relative jog step for every new frame the jog is moving in */
+static void put_jog(midi_out_t* out, const midi_map_t* map) {
+    if (out->jog_seq == out->subucom->seq) {
+        return;
+    }
+    out->jog_seq = out->subucom->seq;
+
+    uint8_t flags = subucom_get_state(out->subucom, SUBUCOM_STATE_JOG)->jog_flags;
+    if (flags & SUBUCOM_IN_JOG_MOVING_MASK) {
+        uint8_t step = (flags & SUBUCOM_IN_JOG_DIR_MASK) ? MIDI_JOG_CW : MIDI_JOG_CCW;
+        put(out, CONTROL_CHANGE | map->channel, map->jog_cc, step);
+    }
+}
+
+/*
+ * Encode the jog and the changed continuous values and write everything
+ * pending in one write(), once per frame. What the fd doesn't take stays
+ * for next time.
+ */
+int midi_out_flush(midi_out_t* out) {
+    const midi_map_t* map = current_map(out);
+
+    if (map != NULL && map->jog_cc != MIDI_NONE && MIDI_BUF_SIZE - out->len >= 3) {
+        put_jog(out, map);
+    }
+
+    for (int i = 0; map != NULL && i < MIDI_NUM_VALUES; i++) {
+        if (map->params[i] == MIDI_NONE || out->values[i] == MIDI_NONE || out->values[i] == out->sent[i]) {
+            continue;
+        }
+        if (MIDI_BUF_SIZE - out->len < MAX_VALUE_BYTES) {
+            break;
+        }
+        put_value(out, map, i);
+    }
+
+    if (out->len == 0) {
+        return 0;
+    }
+
+    ssize_t n = write(out->fd, out->buf, out->len);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    memmove(out->buf, out->buf + n, out->len - n);
+    out->len -= n;
+
+    return 0;
+}
+
+/* sink_write_fn_t feeding key events from a sink_set_t, ctx is the midi_out_t */
+int midi_sink_write(struct sink* sink, const struct sink_event* ev) {
+    if (ev->type != EV_KEY) {
+        return 1;
+    }
+    return midi_out_key((midi_out_t *)sink->ctx, ev->code, ev->value);
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom MIDI output
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __MIDI_H_
+#define __MIDI_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/input.h>
+
+#include "state.h"
+
+#define MIDI_BUF_SIZE       512
+#define MIDI_NONE           0xFFFF
+
+typedef enum midi_msg_type {
+    MIDI_MSG_NONE,
+    MIDI_MSG_NOTE,          /* note on while held, velocity 0 on release */
+    MIDI_MSG_CC             /* 127 while held, 0 on release */
+} midi_msg_type_t;
+
+typedef struct midi_key {
+    uint8_t type;           /* midi_msg_type_t */
+    uint8_t number;
+    uint8_t channel;        /* filled in when held */
+} midi_key_t;
+
+/* continuous controls, sent as 14 bit values */
+enum midi_value {
+    MIDI_TEMPO,             /* tempo_slider, CC pair */
+    MIDI_TOUCH_X,           /* touch_x, NRPN */
+    MIDI_TOUCH_Y,           /* touch_y, NRPN */
+    MIDI_NUM_VALUES
+};
+
+/* relative jog CC values, one per frame the jog moves */
+#define MIDI_JOG_CW         65
+#define MIDI_JOG_CCW        63
+
+/*
+ * The [midi] section of a keymap: keycodes emitted by the keymap become
+ * notes or CCs, the continuous controls 14 bit CC pairs (MSB on cc, LSB on
+ * cc + 32) or NRPNs. The jog is a relative CC, from the same JOG_MOVING and
+ * JOG_DIR flags the jog keys are decoded from.
+ */
+typedef struct midi_map {
+    uint8_t    channel;                     /* 0-15 */
+    midi_key_t keys[KEY_CNT];
+    uint16_t   params[MIDI_NUM_VALUES];     /* CC or NRPN number, MIDI_NONE if unmapped */
+    uint16_t   jog_cc;                      /* MIDI_NONE if unmapped */
+} midi_map_t;
+
+struct subucom;
+struct sink;
+struct sink_event;
+
+/*
+ * Byte stream to a FIFO or rawmidi port. Key messages are encoded into buf
+ * as they come; continuous values only keep their latest value and are
+ * encoded by midi_out_flush(), so intermediate values within a frame never
+ * go out. Everything uses running status.
+ */
+typedef struct midi_out {
+    int             fd;
+    struct subucom* subucom;                /* the [midi] map of its keymap applies */
+
+    uint8_t         buf[MIDI_BUF_SIZE];
+    uint16_t        len;
+    uint8_t         status;                 /* running status, 0 if none */
+    uint16_t        nrpn;                   /* NRPN selected, MIDI_NONE if none */
+    midi_key_t      held[KEY_CNT];          /* message each held key started */
+
+    uint16_t        values[MIDI_NUM_VALUES];
+    uint16_t        sent[MIDI_NUM_VALUES];  /* MIDI_NONE until first sent */
+    uint32_t        jog_seq;                /* last frame the jog was encoded for */
+} midi_out_t;
+
+midi_map_t* midi_map_alloc(void);
+int         midi_map_parse(midi_map_t* map, const char* key, char* value);
+
+int  midi_out_open(midi_out_t* out, struct subucom* subucom, const char* path);
+void midi_out_close(midi_out_t* out);
+int  midi_out_key(midi_out_t* out, int code, int val);
+void midi_out_state(midi_out_t* out, const subucom_state_t* state);
+int  midi_out_flush(midi_out_t* out);
+int  midi_sink_write(struct sink* sink, const struct sink_event* ev);
+
+#endif /* __MIDI_H_ */
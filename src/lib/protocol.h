@@ -0,0 +1,676 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom protocol fields
+ *
+ *  Generated by doc/gen_protocol.js from doc/subucom_fields.js, do not edit.
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __PROTOCOL_H_
+#define __PROTOCOL_H_
+
+/*
+ * Every field has _BYTE (first byte, multi-byte fields are big endian),
+ * _SHIFT and _WIDTH in bits, and _MASK (within its byte for fields of up
+ * to 8 bits).
+ */
+
+/* input frame */
+#define SUBUCOM_IN_MAJOR_REVISION_BYTE           0x02
+#define SUBUCOM_IN_MAJOR_REVISION_SHIFT          0
+#define SUBUCOM_IN_MAJOR_REVISION_WIDTH          8
+#define SUBUCOM_IN_MAJOR_REVISION_MASK           0xFF
+#define SUBUCOM_IN_MINOR_REVISION_BYTE           0x03
+#define SUBUCOM_IN_MINOR_REVISION_SHIFT          0
+#define SUBUCOM_IN_MINOR_REVISION_WIDTH          8
+#define SUBUCOM_IN_MINOR_REVISION_MASK           0xFF
+#define SUBUCOM_IN_SLIP_PADDLE_BYTE              0x04
+#define SUBUCOM_IN_SLIP_PADDLE_SHIFT             0
+#define SUBUCOM_IN_SLIP_PADDLE_WIDTH             2
+#define SUBUCOM_IN_SLIP_PADDLE_MASK              0x03
+#define SUBUCOM_IN_PLAY_BYTE                     0x05
+#define SUBUCOM_IN_PLAY_SHIFT                    0
+#define SUBUCOM_IN_PLAY_WIDTH                    1
+#define SUBUCOM_IN_PLAY_MASK                     0x01
+#define SUBUCOM_IN_CUE_BYTE                      0x05
+#define SUBUCOM_IN_CUE_SHIFT                     1
+#define SUBUCOM_IN_CUE_WIDTH                     1
+#define SUBUCOM_IN_CUE_MASK                      0x02
+#define SUBUCOM_IN_SEARCH_FWD_BYTE               0x05
+#define SUBUCOM_IN_SEARCH_FWD_SHIFT              2
+#define SUBUCOM_IN_SEARCH_FWD_WIDTH              1
+#define SUBUCOM_IN_SEARCH_FWD_MASK               0x04
+#define SUBUCOM_IN_SEARCH_REV_BYTE               0x05
+#define SUBUCOM_IN_SEARCH_REV_SHIFT              3
+#define SUBUCOM_IN_SEARCH_REV_WIDTH              1
+#define SUBUCOM_IN_SEARCH_REV_MASK               0x08
+#define SUBUCOM_IN_TRACK_FWD_BYTE                0x05
+#define SUBUCOM_IN_TRACK_FWD_SHIFT               4
+#define SUBUCOM_IN_TRACK_FWD_WIDTH               1
+#define SUBUCOM_IN_TRACK_FWD_MASK                0x10
+#define SUBUCOM_IN_TRACK_REV_BYTE                0x05
+#define SUBUCOM_IN_TRACK_REV_SHIFT               5
+#define SUBUCOM_IN_TRACK_REV_WIDTH               1
+#define SUBUCOM_IN_TRACK_REV_MASK                0x20
+#define SUBUCOM_IN_BEATJUMP_FWD_BYTE             0x05
+#define SUBUCOM_IN_BEATJUMP_FWD_SHIFT            6
+#define SUBUCOM_IN_BEATJUMP_FWD_WIDTH            1
+#define SUBUCOM_IN_BEATJUMP_FWD_MASK             0x40
+#define SUBUCOM_IN_BEATJUMP_REV_BYTE             0x05
+#define SUBUCOM_IN_BEATJUMP_REV_SHIFT            7
+#define SUBUCOM_IN_BEATJUMP_REV_WIDTH            1
+#define SUBUCOM_IN_BEATJUMP_REV_MASK             0x80
+#define SUBUCOM_IN_TEMPO_RESET_BYTE              0x06
+#define SUBUCOM_IN_TEMPO_RESET_SHIFT             0
+#define SUBUCOM_IN_TEMPO_RESET_WIDTH             1
+#define SUBUCOM_IN_TEMPO_RESET_MASK              0x01
+#define SUBUCOM_IN_TEMPO_MASTER_BYTE             0x06
+#define SUBUCOM_IN_TEMPO_MASTER_SHIFT            1
+#define SUBUCOM_IN_TEMPO_MASTER_WIDTH            1
+#define SUBUCOM_IN_TEMPO_MASTER_MASK             0x02
+#define SUBUCOM_IN_TEMPO_RANGE_BYTE              0x06
+#define SUBUCOM_IN_TEMPO_RANGE_SHIFT             2
+#define SUBUCOM_IN_TEMPO_RANGE_WIDTH             1
+#define SUBUCOM_IN_TEMPO_RANGE_MASK              0x04
+#define SUBUCOM_IN_KEYSYNC_BYTE                  0x06
+#define SUBUCOM_IN_KEYSYNC_SHIFT                 4
+#define SUBUCOM_IN_KEYSYNC_WIDTH                 1
+#define SUBUCOM_IN_KEYSYNC_MASK                  0x10
+#define SUBUCOM_IN_BEATSYNC_BYTE                 0x06
+#define SUBUCOM_IN_BEATSYNC_SHIFT                5
+#define SUBUCOM_IN_BEATSYNC_WIDTH                1
+#define SUBUCOM_IN_BEATSYNC_MASK                 0x20
+#define SUBUCOM_IN_MASTER_BYTE                   0x06
+#define SUBUCOM_IN_MASTER_SHIFT                  6
+#define SUBUCOM_IN_MASTER_WIDTH                  1
+#define SUBUCOM_IN_MASTER_MASK                   0x40
+#define SUBUCOM_IN_LOOP_IN_BYTE                  0x07
+#define SUBUCOM_IN_LOOP_IN_SHIFT                 0
+#define SUBUCOM_IN_LOOP_IN_WIDTH                 1
+#define SUBUCOM_IN_LOOP_IN_MASK                  0x01
+#define SUBUCOM_IN_LOOP_OUT_BYTE                 0x07
+#define SUBUCOM_IN_LOOP_OUT_SHIFT                1
+#define SUBUCOM_IN_LOOP_OUT_WIDTH                1
+#define SUBUCOM_IN_LOOP_OUT_MASK                 0x02
+#define SUBUCOM_IN_RELOOP_BYTE                   0x07
+#define SUBUCOM_IN_RELOOP_SHIFT                  2
+#define SUBUCOM_IN_RELOOP_WIDTH                  1
+#define SUBUCOM_IN_RELOOP_MASK                   0x04
+#define SUBUCOM_IN_BEAT_LOOP_4_BYTE              0x07
+#define SUBUCOM_IN_BEAT_LOOP_4_SHIFT             4
+#define SUBUCOM_IN_BEAT_LOOP_4_WIDTH             1
+#define SUBUCOM_IN_BEAT_LOOP_4_MASK              0x10
+#define SUBUCOM_IN_BEAT_LOOP_8_BYTE              0x07
+#define SUBUCOM_IN_BEAT_LOOP_8_SHIFT             5
+#define SUBUCOM_IN_BEAT_LOOP_8_WIDTH             1
+#define SUBUCOM_IN_BEAT_LOOP_8_MASK              0x20
+#define SUBUCOM_IN_SLIP_BYTE                     0x07
+#define SUBUCOM_IN_SLIP_SHIFT                    7
+#define SUBUCOM_IN_SLIP_WIDTH                    1
+#define SUBUCOM_IN_SLIP_MASK                     0x80
+#define SUBUCOM_IN_MEMORY_BYTE                   0x08
+#define SUBUCOM_IN_MEMORY_SHIFT                  0
+#define SUBUCOM_IN_MEMORY_WIDTH                  1
+#define SUBUCOM_IN_MEMORY_MASK                   0x01
+#define SUBUCOM_IN_MEM_DELETE_BYTE               0x08
+#define SUBUCOM_IN_MEM_DELETE_SHIFT              1
+#define SUBUCOM_IN_MEM_DELETE_WIDTH              1
+#define SUBUCOM_IN_MEM_DELETE_MASK               0x02
+#define SUBUCOM_IN_MEM_CUE_FWD_BYTE              0x08
+#define SUBUCOM_IN_MEM_CUE_FWD_SHIFT             2
+#define SUBUCOM_IN_MEM_CUE_FWD_WIDTH             1
+#define SUBUCOM_IN_MEM_CUE_FWD_MASK              0x04
+#define SUBUCOM_IN_MEM_CUE_REV_BYTE              0x08
+#define SUBUCOM_IN_MEM_CUE_REV_SHIFT             3
+#define SUBUCOM_IN_MEM_CUE_REV_WIDTH             1
+#define SUBUCOM_IN_MEM_CUE_REV_MASK              0x08
+#define SUBUCOM_IN_CALL_DELETE_BYTE              0x08
+#define SUBUCOM_IN_CALL_DELETE_SHIFT             5
+#define SUBUCOM_IN_CALL_DELETE_WIDTH             1
+#define SUBUCOM_IN_CALL_DELETE_MASK              0x20
+#define SUBUCOM_IN_HOTCUE_A_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_A_SHIFT                0
+#define SUBUCOM_IN_HOTCUE_A_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_A_MASK                 0x01
+#define SUBUCOM_IN_HOTCUE_B_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_B_SHIFT                1
+#define SUBUCOM_IN_HOTCUE_B_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_B_MASK                 0x02
+#define SUBUCOM_IN_HOTCUE_C_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_C_SHIFT                2
+#define SUBUCOM_IN_HOTCUE_C_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_C_MASK                 0x04
+#define SUBUCOM_IN_HOTCUE_D_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_D_SHIFT                3
+#define SUBUCOM_IN_HOTCUE_D_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_D_MASK                 0x08
+#define SUBUCOM_IN_HOTCUE_E_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_E_SHIFT                4
+#define SUBUCOM_IN_HOTCUE_E_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_E_MASK                 0x10
+#define SUBUCOM_IN_HOTCUE_F_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_F_SHIFT                5
+#define SUBUCOM_IN_HOTCUE_F_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_F_MASK                 0x20
+#define SUBUCOM_IN_HOTCUE_G_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_G_SHIFT                6
+#define SUBUCOM_IN_HOTCUE_G_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_G_MASK                 0x40
+#define SUBUCOM_IN_HOTCUE_H_BYTE                 0x09
+#define SUBUCOM_IN_HOTCUE_H_SHIFT                7
+#define SUBUCOM_IN_HOTCUE_H_WIDTH                1
+#define SUBUCOM_IN_HOTCUE_H_MASK                 0x80
+#define SUBUCOM_IN_SOURCE_BYTE                   0x0A
+#define SUBUCOM_IN_SOURCE_SHIFT                  0
+#define SUBUCOM_IN_SOURCE_WIDTH                  1
+#define SUBUCOM_IN_SOURCE_MASK                   0x01
+#define SUBUCOM_IN_BROWSE_BYTE                   0x0A
+#define SUBUCOM_IN_BROWSE_SHIFT                  1
+#define SUBUCOM_IN_BROWSE_WIDTH                  1
+#define SUBUCOM_IN_BROWSE_MASK                   0x02
+#define SUBUCOM_IN_TAGLIST_BYTE                  0x0A
+#define SUBUCOM_IN_TAGLIST_SHIFT                 2
+#define SUBUCOM_IN_TAGLIST_WIDTH                 1
+#define SUBUCOM_IN_TAGLIST_MASK                  0x04
+#define SUBUCOM_IN_PLAYLIST_BYTE                 0x0A
+#define SUBUCOM_IN_PLAYLIST_SHIFT                3
+#define SUBUCOM_IN_PLAYLIST_WIDTH                1
+#define SUBUCOM_IN_PLAYLIST_MASK                 0x08
+#define SUBUCOM_IN_SEARCH_BYTE                   0x0A
+#define SUBUCOM_IN_SEARCH_SHIFT                  4
+#define SUBUCOM_IN_SEARCH_WIDTH                  1
+#define SUBUCOM_IN_SEARCH_MASK                   0x10
+#define SUBUCOM_IN_MENU_BYTE                     0x0A
+#define SUBUCOM_IN_MENU_SHIFT                    5
+#define SUBUCOM_IN_MENU_WIDTH                    1
+#define SUBUCOM_IN_MENU_MASK                     0x20
+#define SUBUCOM_IN_JOG_MODE_BYTE                 0x0A
+#define SUBUCOM_IN_JOG_MODE_SHIFT                7
+#define SUBUCOM_IN_JOG_MODE_WIDTH                1
+#define SUBUCOM_IN_JOG_MODE_MASK                 0x80
+#define SUBUCOM_IN_BACK_BYTE                     0x0B
+#define SUBUCOM_IN_BACK_SHIFT                    0
+#define SUBUCOM_IN_BACK_WIDTH                    1
+#define SUBUCOM_IN_BACK_MASK                     0x01
+#define SUBUCOM_IN_TAG_TRACK_BYTE                0x0B
+#define SUBUCOM_IN_TAG_TRACK_SHIFT               1
+#define SUBUCOM_IN_TAG_TRACK_WIDTH               1
+#define SUBUCOM_IN_TAG_TRACK_MASK                0x02
+#define SUBUCOM_IN_TRACK_FILTER_BYTE             0x0B
+#define SUBUCOM_IN_TRACK_FILTER_SHIFT            2
+#define SUBUCOM_IN_TRACK_FILTER_WIDTH            1
+#define SUBUCOM_IN_TRACK_FILTER_MASK             0x04
+#define SUBUCOM_IN_SHORTCUT_BYTE                 0x0B
+#define SUBUCOM_IN_SHORTCUT_SHIFT                3
+#define SUBUCOM_IN_SHORTCUT_WIDTH                1
+#define SUBUCOM_IN_SHORTCUT_MASK                 0x08
+#define SUBUCOM_IN_ROTARY_SEL_BYTE               0x0B
+#define SUBUCOM_IN_ROTARY_SEL_SHIFT              4
+#define SUBUCOM_IN_ROTARY_SEL_WIDTH              1
+#define SUBUCOM_IN_ROTARY_SEL_MASK               0x10
+#define SUBUCOM_IN_TIME_BYTE                     0x0B
+#define SUBUCOM_IN_TIME_SHIFT                    6
+#define SUBUCOM_IN_TIME_WIDTH                    1
+#define SUBUCOM_IN_TIME_MASK                     0x40
+#define SUBUCOM_IN_QUANTIZE_BYTE                 0x0B
+#define SUBUCOM_IN_QUANTIZE_SHIFT                7
+#define SUBUCOM_IN_QUANTIZE_WIDTH                1
+#define SUBUCOM_IN_QUANTIZE_MASK                 0x80
+#define SUBUCOM_IN_SD_BYTE                       0x0C
+#define SUBUCOM_IN_SD_SHIFT                      0
+#define SUBUCOM_IN_SD_WIDTH                      1
+#define SUBUCOM_IN_SD_MASK                       0x01
+#define SUBUCOM_IN_USB_STOP_BYTE                 0x0C
+#define SUBUCOM_IN_USB_STOP_SHIFT                1
+#define SUBUCOM_IN_USB_STOP_WIDTH                1
+#define SUBUCOM_IN_USB_STOP_MASK                 0x02
+#define SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE       0x0E
+#define SUBUCOM_IN_ROTARY_ENCODER_POS_SHIFT      0
+#define SUBUCOM_IN_ROTARY_ENCODER_POS_WIDTH      16
+#define SUBUCOM_IN_ROTARY_ENCODER_POS_MASK       0xFFFF
+#define SUBUCOM_IN_TOUCHSCREEN_X_BYTE            0x10
+#define SUBUCOM_IN_TOUCHSCREEN_X_SHIFT           0
+#define SUBUCOM_IN_TOUCHSCREEN_X_WIDTH           16
+#define SUBUCOM_IN_TOUCHSCREEN_X_MASK            0xFFFF
+#define SUBUCOM_IN_TOUCHSCREEN_Y_BYTE            0x12
+#define SUBUCOM_IN_TOUCHSCREEN_Y_SHIFT           0
+#define SUBUCOM_IN_TOUCHSCREEN_Y_WIDTH           16
+#define SUBUCOM_IN_TOUCHSCREEN_Y_MASK            0xFFFF
+#define SUBUCOM_IN_TEMPO_SLIDER_POS_BYTE         0x16
+#define SUBUCOM_IN_TEMPO_SLIDER_POS_SHIFT        0
+#define SUBUCOM_IN_TEMPO_SLIDER_POS_WIDTH        16
+#define SUBUCOM_IN_TEMPO_SLIDER_POS_MASK         0xFFFF
+#define SUBUCOM_IN_VINYL_SPEED_POS_BYTE          0x18
+#define SUBUCOM_IN_VINYL_SPEED_POS_SHIFT         0
+#define SUBUCOM_IN_VINYL_SPEED_POS_WIDTH         16
+#define SUBUCOM_IN_VINYL_SPEED_POS_MASK          0xFFFF
+#define SUBUCOM_IN_JOG_POS_BYTE                  0x1A
+#define SUBUCOM_IN_JOG_POS_SHIFT                 0
+#define SUBUCOM_IN_JOG_POS_WIDTH                 16
+#define SUBUCOM_IN_JOG_POS_MASK                  0xFFFF
+#define SUBUCOM_IN_JOG_SPEED_BYTE                0x1C
+#define SUBUCOM_IN_JOG_SPEED_SHIFT               0
+#define SUBUCOM_IN_JOG_SPEED_WIDTH               16
+#define SUBUCOM_IN_JOG_SPEED_MASK                0xFFFF
+#define SUBUCOM_IN_JOG_START_BYTE                0x1E
+#define SUBUCOM_IN_JOG_START_SHIFT               0
+#define SUBUCOM_IN_JOG_START_WIDTH               1
+#define SUBUCOM_IN_JOG_START_MASK                0x01
+#define SUBUCOM_IN_JOG_PRESS_BYTE                0x1E
+#define SUBUCOM_IN_JOG_PRESS_SHIFT               1
+#define SUBUCOM_IN_JOG_PRESS_WIDTH               1
+#define SUBUCOM_IN_JOG_PRESS_MASK                0x02
+#define SUBUCOM_IN_JOG_DIR_BYTE                  0x1E
+#define SUBUCOM_IN_JOG_DIR_SHIFT                 2
+#define SUBUCOM_IN_JOG_DIR_WIDTH                 1
+#define SUBUCOM_IN_JOG_DIR_MASK                  0x04
+#define SUBUCOM_IN_JOG_MOVING_BYTE               0x1E
+#define SUBUCOM_IN_JOG_MOVING_SHIFT              3
+#define SUBUCOM_IN_JOG_MOVING_WIDTH              1
+#define SUBUCOM_IN_JOG_MOVING_MASK               0x08
+
+/* input keys exclusive with one another */
+/* SEARCH_FWD, SEARCH_REV, TRACK_FWD, TRACK_REV */
+#define SUBUCOM_IN_GROUP1_BYTE                   0x05
+#define SUBUCOM_IN_GROUP1_MASK                   0x3C
+/* TEMPO_MASTER, TEMPO_RANGE, KEYSYNC, BEATSYNC, MASTER */
+#define SUBUCOM_IN_GROUP2_BYTE                   0x06
+#define SUBUCOM_IN_GROUP2_MASK                   0x76
+/* MEMORY, MEM_DELETE, MEM_CUE_FWD, MEM_CUE_REV */
+#define SUBUCOM_IN_GROUP3_BYTE                   0x08
+#define SUBUCOM_IN_GROUP3_MASK                   0x0F
+/* SOURCE, BROWSE, TAGLIST, PLAYLIST, SEARCH, MENU */
+#define SUBUCOM_IN_GROUP4_BYTE                   0x0A
+#define SUBUCOM_IN_GROUP4_MASK                   0x3F
+/* BACK, TAG_TRACK, TRACK_FILTER, SHORTCUT, ROTARY_SEL */
+#define SUBUCOM_IN_GROUP5_BYTE                   0x0B
+#define SUBUCOM_IN_GROUP5_MASK                   0x1F
+
+/* output frame */
+#define SUBUCOM_OUT_KEYSYNC_BYTE                 0x02
+#define SUBUCOM_OUT_KEYSYNC_SHIFT                0
+#define SUBUCOM_OUT_KEYSYNC_WIDTH                2
+#define SUBUCOM_OUT_KEYSYNC_MASK                 0x03
+#define SUBUCOM_OUT_BEATSYNC_BYTE                0x02
+#define SUBUCOM_OUT_BEATSYNC_SHIFT               2
+#define SUBUCOM_OUT_BEATSYNC_WIDTH               2
+#define SUBUCOM_OUT_BEATSYNC_MASK                0x0C
+#define SUBUCOM_OUT_MASTER_BYTE                  0x02
+#define SUBUCOM_OUT_MASTER_SHIFT                 4
+#define SUBUCOM_OUT_MASTER_WIDTH                 2
+#define SUBUCOM_OUT_MASTER_MASK                  0x30
+#define SUBUCOM_OUT_JOG_RED_BYTE                 0x03
+#define SUBUCOM_OUT_JOG_RED_SHIFT                0
+#define SUBUCOM_OUT_JOG_RED_WIDTH                2
+#define SUBUCOM_OUT_JOG_RED_MASK                 0x03
+#define SUBUCOM_OUT_JOG_WHITE_BYTE               0x03
+#define SUBUCOM_OUT_JOG_WHITE_SHIFT              2
+#define SUBUCOM_OUT_JOG_WHITE_WIDTH              2
+#define SUBUCOM_OUT_JOG_WHITE_MASK               0x0C
+#define SUBUCOM_OUT_SLIP_BYTE                    0x03
+#define SUBUCOM_OUT_SLIP_SHIFT                   4
+#define SUBUCOM_OUT_SLIP_WIDTH                   2
+#define SUBUCOM_OUT_SLIP_MASK                    0x30
+#define SUBUCOM_OUT_QUANTIZE_BYTE                0x03
+#define SUBUCOM_OUT_QUANTIZE_SHIFT               6
+#define SUBUCOM_OUT_QUANTIZE_WIDTH               2
+#define SUBUCOM_OUT_QUANTIZE_MASK                0xC0
+#define SUBUCOM_OUT_SOURCE_BYTE                  0x04
+#define SUBUCOM_OUT_SOURCE_SHIFT                 0
+#define SUBUCOM_OUT_SOURCE_WIDTH                 2
+#define SUBUCOM_OUT_SOURCE_MASK                  0x03
+#define SUBUCOM_OUT_BROWSE_BYTE                  0x04
+#define SUBUCOM_OUT_BROWSE_SHIFT                 2
+#define SUBUCOM_OUT_BROWSE_WIDTH                 2
+#define SUBUCOM_OUT_BROWSE_MASK                  0x0C
+#define SUBUCOM_OUT_TAGLIST_BYTE                 0x04
+#define SUBUCOM_OUT_TAGLIST_SHIFT                4
+#define SUBUCOM_OUT_TAGLIST_WIDTH                2
+#define SUBUCOM_OUT_TAGLIST_MASK                 0x30
+#define SUBUCOM_OUT_PLAYLIST_BYTE                0x04
+#define SUBUCOM_OUT_PLAYLIST_SHIFT               6
+#define SUBUCOM_OUT_PLAYLIST_WIDTH               2
+#define SUBUCOM_OUT_PLAYLIST_MASK                0xC0
+#define SUBUCOM_OUT_SEARCH_BYTE                  0x05
+#define SUBUCOM_OUT_SEARCH_SHIFT                 0
+#define SUBUCOM_OUT_SEARCH_WIDTH                 2
+#define SUBUCOM_OUT_SEARCH_MASK                  0x03
+#define SUBUCOM_OUT_MENU_BYTE                    0x05
+#define SUBUCOM_OUT_MENU_SHIFT                   2
+#define SUBUCOM_OUT_MENU_WIDTH                   2
+#define SUBUCOM_OUT_MENU_MASK                    0x0C
+#define SUBUCOM_OUT_PLAY_BYTE                    0x07
+#define SUBUCOM_OUT_PLAY_SHIFT                   0
+#define SUBUCOM_OUT_PLAY_WIDTH                   1
+#define SUBUCOM_OUT_PLAY_MASK                    0x01
+#define SUBUCOM_OUT_CUE_BYTE                     0x07
+#define SUBUCOM_OUT_CUE_SHIFT                    1
+#define SUBUCOM_OUT_CUE_WIDTH                    1
+#define SUBUCOM_OUT_CUE_MASK                     0x02
+#define SUBUCOM_OUT_CUE_IN_BYTE                  0x07
+#define SUBUCOM_OUT_CUE_IN_SHIFT                 3
+#define SUBUCOM_OUT_CUE_IN_WIDTH                 1
+#define SUBUCOM_OUT_CUE_IN_MASK                  0x08
+#define SUBUCOM_OUT_CUE_OUT_BYTE                 0x07
+#define SUBUCOM_OUT_CUE_OUT_SHIFT                4
+#define SUBUCOM_OUT_CUE_OUT_WIDTH                1
+#define SUBUCOM_OUT_CUE_OUT_MASK                 0x10
+#define SUBUCOM_OUT_RELOOP_BYTE                  0x07
+#define SUBUCOM_OUT_RELOOP_SHIFT                 5
+#define SUBUCOM_OUT_RELOOP_WIDTH                 1
+#define SUBUCOM_OUT_RELOOP_MASK                  0x20
+#define SUBUCOM_OUT_BEAT_LOOP_4_BYTE             0x07
+#define SUBUCOM_OUT_BEAT_LOOP_4_SHIFT            6
+#define SUBUCOM_OUT_BEAT_LOOP_4_WIDTH            1
+#define SUBUCOM_OUT_BEAT_LOOP_4_MASK             0x40
+#define SUBUCOM_OUT_BEAT_LOOP_8_BYTE             0x07
+#define SUBUCOM_OUT_BEAT_LOOP_8_SHIFT            7
+#define SUBUCOM_OUT_BEAT_LOOP_8_WIDTH            1
+#define SUBUCOM_OUT_BEAT_LOOP_8_MASK             0x80
+#define SUBUCOM_OUT_BEATJUMP_FWD_BYTE            0x08
+#define SUBUCOM_OUT_BEATJUMP_FWD_SHIFT           0
+#define SUBUCOM_OUT_BEATJUMP_FWD_WIDTH           1
+#define SUBUCOM_OUT_BEATJUMP_FWD_MASK            0x01
+#define SUBUCOM_OUT_BEATJUMP_REV_BYTE            0x08
+#define SUBUCOM_OUT_BEATJUMP_REV_SHIFT           1
+#define SUBUCOM_OUT_BEATJUMP_REV_WIDTH           1
+#define SUBUCOM_OUT_BEATJUMP_REV_MASK            0x02
+#define SUBUCOM_OUT_TEMPO_RESET_BYTE             0x08
+#define SUBUCOM_OUT_TEMPO_RESET_SHIFT            3
+#define SUBUCOM_OUT_TEMPO_RESET_WIDTH            1
+#define SUBUCOM_OUT_TEMPO_RESET_MASK             0x08
+#define SUBUCOM_OUT_MASTER_TEMPO_BYTE            0x08
+#define SUBUCOM_OUT_MASTER_TEMPO_SHIFT           4
+#define SUBUCOM_OUT_MASTER_TEMPO_WIDTH           1
+#define SUBUCOM_OUT_MASTER_TEMPO_MASK            0x10
+#define SUBUCOM_OUT_CDJ_MODE_BYTE                0x08
+#define SUBUCOM_OUT_CDJ_MODE_SHIFT               6
+#define SUBUCOM_OUT_CDJ_MODE_WIDTH               1
+#define SUBUCOM_OUT_CDJ_MODE_MASK                0x40
+#define SUBUCOM_OUT_VINYL_MODE_BYTE              0x08
+#define SUBUCOM_OUT_VINYL_MODE_SHIFT             7
+#define SUBUCOM_OUT_VINYL_MODE_WIDTH             1
+#define SUBUCOM_OUT_VINYL_MODE_MASK              0x80
+#define SUBUCOM_OUT_ROTARY_ENC_BYTE              0x09
+#define SUBUCOM_OUT_ROTARY_ENC_SHIFT             0
+#define SUBUCOM_OUT_ROTARY_ENC_WIDTH             1
+#define SUBUCOM_OUT_ROTARY_ENC_MASK              0x01
+#define SUBUCOM_OUT_SEARCH_MEM_BYTE              0x09
+#define SUBUCOM_OUT_SEARCH_MEM_SHIFT             2
+#define SUBUCOM_OUT_SEARCH_MEM_WIDTH             1
+#define SUBUCOM_OUT_SEARCH_MEM_MASK              0x04
+#define SUBUCOM_OUT_REV_BYTE                     0x09
+#define SUBUCOM_OUT_REV_SHIFT                    4
+#define SUBUCOM_OUT_REV_WIDTH                    1
+#define SUBUCOM_OUT_REV_MASK                     0x10
+#define SUBUCOM_OUT_EUP_BYTE                     0x09
+#define SUBUCOM_OUT_EUP_SHIFT                    7
+#define SUBUCOM_OUT_EUP_WIDTH                    1
+#define SUBUCOM_OUT_EUP_MASK                     0x80
+#define SUBUCOM_OUT_HOTCUE_A_R_BYTE              0x0C
+#define SUBUCOM_OUT_HOTCUE_A_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_A_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_A_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_A_G_BYTE              0x0D
+#define SUBUCOM_OUT_HOTCUE_A_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_A_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_A_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_A_B_BYTE              0x0E
+#define SUBUCOM_OUT_HOTCUE_A_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_A_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_A_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_B_R_BYTE              0x0F
+#define SUBUCOM_OUT_HOTCUE_B_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_B_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_B_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_B_G_BYTE              0x10
+#define SUBUCOM_OUT_HOTCUE_B_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_B_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_B_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_B_B_BYTE              0x11
+#define SUBUCOM_OUT_HOTCUE_B_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_B_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_B_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_C_R_BYTE              0x12
+#define SUBUCOM_OUT_HOTCUE_C_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_C_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_C_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_C_G_BYTE              0x13
+#define SUBUCOM_OUT_HOTCUE_C_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_C_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_C_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_C_B_BYTE              0x14
+#define SUBUCOM_OUT_HOTCUE_C_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_C_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_C_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_D_R_BYTE              0x15
+#define SUBUCOM_OUT_HOTCUE_D_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_D_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_D_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_D_G_BYTE              0x16
+#define SUBUCOM_OUT_HOTCUE_D_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_D_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_D_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_D_B_BYTE              0x17
+#define SUBUCOM_OUT_HOTCUE_D_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_D_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_D_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_E_R_BYTE              0x18
+#define SUBUCOM_OUT_HOTCUE_E_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_E_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_E_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_E_G_BYTE              0x19
+#define SUBUCOM_OUT_HOTCUE_E_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_E_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_E_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_E_B_BYTE              0x1A
+#define SUBUCOM_OUT_HOTCUE_E_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_E_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_E_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_F_R_BYTE              0x1B
+#define SUBUCOM_OUT_HOTCUE_F_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_F_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_F_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_F_G_BYTE              0x1C
+#define SUBUCOM_OUT_HOTCUE_F_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_F_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_F_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_F_B_BYTE              0x1D
+#define SUBUCOM_OUT_HOTCUE_F_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_F_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_F_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_G_R_BYTE              0x1E
+#define SUBUCOM_OUT_HOTCUE_G_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_G_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_G_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_G_G_BYTE              0x1F
+#define SUBUCOM_OUT_HOTCUE_G_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_G_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_G_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_G_B_BYTE              0x20
+#define SUBUCOM_OUT_HOTCUE_G_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_G_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_G_B_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_H_R_BYTE              0x21
+#define SUBUCOM_OUT_HOTCUE_H_R_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_H_R_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_H_R_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_H_G_BYTE              0x22
+#define SUBUCOM_OUT_HOTCUE_H_G_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_H_G_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_H_G_MASK              0xFF
+#define SUBUCOM_OUT_HOTCUE_H_B_BYTE              0x23
+#define SUBUCOM_OUT_HOTCUE_H_B_SHIFT             0
+#define SUBUCOM_OUT_HOTCUE_H_B_WIDTH             8
+#define SUBUCOM_OUT_HOTCUE_H_B_MASK              0xFF
+#define SUBUCOM_OUT_SD_R_BYTE                    0x24
+#define SUBUCOM_OUT_SD_R_SHIFT                   0
+#define SUBUCOM_OUT_SD_R_WIDTH                   8
+#define SUBUCOM_OUT_SD_R_MASK                    0xFF
+#define SUBUCOM_OUT_SD_G_BYTE                    0x25
+#define SUBUCOM_OUT_SD_G_SHIFT                   0
+#define SUBUCOM_OUT_SD_G_WIDTH                   8
+#define SUBUCOM_OUT_SD_G_MASK                    0xFF
+#define SUBUCOM_OUT_SD_B_BYTE                    0x26
+#define SUBUCOM_OUT_SD_B_SHIFT                   0
+#define SUBUCOM_OUT_SD_B_WIDTH                   8
+#define SUBUCOM_OUT_SD_B_MASK                    0xFF
+#define SUBUCOM_OUT_USB_R_BYTE                   0x27
+#define SUBUCOM_OUT_USB_R_SHIFT                  0
+#define SUBUCOM_OUT_USB_R_WIDTH                  8
+#define SUBUCOM_OUT_USB_R_MASK                   0xFF
+#define SUBUCOM_OUT_USB_G_BYTE                   0x28
+#define SUBUCOM_OUT_USB_G_SHIFT                  0
+#define SUBUCOM_OUT_USB_G_WIDTH                  8
+#define SUBUCOM_OUT_USB_G_MASK                   0xFF
+#define SUBUCOM_OUT_USB_B_BYTE                   0x29
+#define SUBUCOM_OUT_USB_B_SHIFT                  0
+#define SUBUCOM_OUT_USB_B_WIDTH                  8
+#define SUBUCOM_OUT_USB_B_MASK                   0xFF
+#define SUBUCOM_OUT_MEDIA_COLOR_R_BYTE           0x2A
+#define SUBUCOM_OUT_MEDIA_COLOR_R_SHIFT          0
+#define SUBUCOM_OUT_MEDIA_COLOR_R_WIDTH          8
+#define SUBUCOM_OUT_MEDIA_COLOR_R_MASK           0xFF
+#define SUBUCOM_OUT_MEDIA_COLOR_G_BYTE           0x2B
+#define SUBUCOM_OUT_MEDIA_COLOR_G_SHIFT          0
+#define SUBUCOM_OUT_MEDIA_COLOR_G_WIDTH          8
+#define SUBUCOM_OUT_MEDIA_COLOR_G_MASK           0xFF
+#define SUBUCOM_OUT_MEDIA_COLOR_B_BYTE           0x2C
+#define SUBUCOM_OUT_MEDIA_COLOR_B_SHIFT          0
+#define SUBUCOM_OUT_MEDIA_COLOR_B_WIDTH          8
+#define SUBUCOM_OUT_MEDIA_COLOR_B_MASK           0xFF
+
+/* X(name, byte, shift, width) for every field, to build tables from */
+#define SUBUCOM_IN_FIELDS(X) \
+    X(MAJOR_REVISION, 0x02, 0, 8) \
+    X(MINOR_REVISION, 0x03, 0, 8) \
+    X(SLIP_PADDLE, 0x04, 0, 2) \
+    X(PLAY, 0x05, 0, 1) \
+    X(CUE, 0x05, 1, 1) \
+    X(SEARCH_FWD, 0x05, 2, 1) \
+    X(SEARCH_REV, 0x05, 3, 1) \
+    X(TRACK_FWD, 0x05, 4, 1) \
+    X(TRACK_REV, 0x05, 5, 1) \
+    X(BEATJUMP_FWD, 0x05, 6, 1) \
+    X(BEATJUMP_REV, 0x05, 7, 1) \
+    X(TEMPO_RESET, 0x06, 0, 1) \
+    X(TEMPO_MASTER, 0x06, 1, 1) \
+    X(TEMPO_RANGE, 0x06, 2, 1) \
+    X(KEYSYNC, 0x06, 4, 1) \
+    X(BEATSYNC, 0x06, 5, 1) \
+    X(MASTER, 0x06, 6, 1) \
+    X(LOOP_IN, 0x07, 0, 1) \
+    X(LOOP_OUT, 0x07, 1, 1) \
+    X(RELOOP, 0x07, 2, 1) \
+    X(BEAT_LOOP_4, 0x07, 4, 1) \
+    X(BEAT_LOOP_8, 0x07, 5, 1) \
+    X(SLIP, 0x07, 7, 1) \
+    X(MEMORY, 0x08, 0, 1) \
+    X(MEM_DELETE, 0x08, 1, 1) \
+    X(MEM_CUE_FWD, 0x08, 2, 1) \
+    X(MEM_CUE_REV, 0x08, 3, 1) \
+    X(CALL_DELETE, 0x08, 5, 1) \
+    X(HOTCUE_A, 0x09, 0, 1) \
+    X(HOTCUE_B, 0x09, 1, 1) \
+    X(HOTCUE_C, 0x09, 2, 1) \
+    X(HOTCUE_D, 0x09, 3, 1) \
+    X(HOTCUE_E, 0x09, 4, 1) \
+    X(HOTCUE_F, 0x09, 5, 1) \
+    X(HOTCUE_G, 0x09, 6, 1) \
+    X(HOTCUE_H, 0x09, 7, 1) \
+    X(SOURCE, 0x0A, 0, 1) \
+    X(BROWSE, 0x0A, 1, 1) \
+    X(TAGLIST, 0x0A, 2, 1) \
+    X(PLAYLIST, 0x0A, 3, 1) \
+    X(SEARCH, 0x0A, 4, 1) \
+    X(MENU, 0x0A, 5, 1) \
+    X(JOG_MODE, 0x0A, 7, 1) \
+    X(BACK, 0x0B, 0, 1) \
+    X(TAG_TRACK, 0x0B, 1, 1) \
+    X(TRACK_FILTER, 0x0B, 2, 1) \
+    X(SHORTCUT, 0x0B, 3, 1) \
+    X(ROTARY_SEL, 0x0B, 4, 1) \
+    X(TIME, 0x0B, 6, 1) \
+    X(QUANTIZE, 0x0B, 7, 1) \
+    X(SD, 0x0C, 0, 1) \
+    X(USB_STOP, 0x0C, 1, 1) \
+    X(ROTARY_ENCODER_POS, 0x0E, 0, 16) \
+    X(TOUCHSCREEN_X, 0x10, 0, 16) \
+    X(TOUCHSCREEN_Y, 0x12, 0, 16) \
+    X(TEMPO_SLIDER_POS, 0x16, 0, 16) \
+    X(VINYL_SPEED_POS, 0x18, 0, 16) \
+    X(JOG_POS, 0x1A, 0, 16) \
+    X(JOG_SPEED, 0x1C, 0, 16) \
+    X(JOG_START, 0x1E, 0, 1) \
+    X(JOG_PRESS, 0x1E, 1, 1) \
+    X(JOG_DIR, 0x1E, 2, 1) \
+    X(JOG_MOVING, 0x1E, 3, 1)
+
+#define SUBUCOM_OUT_FIELDS(X) \
+    X(KEYSYNC, 0x02, 0, 2) \
+    X(BEATSYNC, 0x02, 2, 2) \
+    X(MASTER, 0x02, 4, 2) \
+    X(JOG_RED, 0x03, 0, 2) \
+    X(JOG_WHITE, 0x03, 2, 2) \
+    X(SLIP, 0x03, 4, 2) \
+    X(QUANTIZE, 0x03, 6, 2) \
+    X(SOURCE, 0x04, 0, 2) \
+    X(BROWSE, 0x04, 2, 2) \
+    X(TAGLIST, 0x04, 4, 2) \
+    X(PLAYLIST, 0x04, 6, 2) \
+    X(SEARCH, 0x05, 0, 2) \
+    X(MENU, 0x05, 2, 2) \
+    X(PLAY, 0x07, 0, 1) \
+    X(CUE, 0x07, 1, 1) \
+    X(CUE_IN, 0x07, 3, 1) \
+    X(CUE_OUT, 0x07, 4, 1) \
+    X(RELOOP, 0x07, 5, 1) \
+    X(BEAT_LOOP_4, 0x07, 6, 1) \
+    X(BEAT_LOOP_8, 0x07, 7, 1) \
+    X(BEATJUMP_FWD, 0x08, 0, 1) \
+    X(BEATJUMP_REV, 0x08, 1, 1) \
+    X(TEMPO_RESET, 0x08, 3, 1) \
+    X(MASTER_TEMPO, 0x08, 4, 1) \
+    X(CDJ_MODE, 0x08, 6, 1) \
+    X(VINYL_MODE, 0x08, 7, 1) \
+    X(ROTARY_ENC, 0x09, 0, 1) \
+    X(SEARCH_MEM, 0x09, 2, 1) \
+    X(REV, 0x09, 4, 1) \
+    X(EUP, 0x09, 7, 1) \
+    X(HOTCUE_A_R, 0x0C, 0, 8) \
+    X(HOTCUE_A_G, 0x0D, 0, 8) \
+    X(HOTCUE_A_B, 0x0E, 0, 8) \
+    X(HOTCUE_B_R, 0x0F, 0, 8) \
+    X(HOTCUE_B_G, 0x10, 0, 8) \
+    X(HOTCUE_B_B, 0x11, 0, 8) \
+    X(HOTCUE_C_R, 0x12, 0, 8) \
+    X(HOTCUE_C_G, 0x13, 0, 8) \
+    X(HOTCUE_C_B, 0x14, 0, 8) \
+    X(HOTCUE_D_R, 0x15, 0, 8) \
+    X(HOTCUE_D_G, 0x16, 0, 8) \
+    X(HOTCUE_D_B, 0x17, 0, 8) \
+    X(HOTCUE_E_R, 0x18, 0, 8) \
+    X(HOTCUE_E_G, 0x19, 0, 8) \
+    X(HOTCUE_E_B, 0x1A, 0, 8) \
+    X(HOTCUE_F_R, 0x1B, 0, 8) \
+    X(HOTCUE_F_G, 0x1C, 0, 8) \
+    X(HOTCUE_F_B, 0x1D, 0, 8) \
+    X(HOTCUE_G_R, 0x1E, 0, 8) \
+    X(HOTCUE_G_G, 0x1F, 0, 8) \
+    X(HOTCUE_G_B, 0x20, 0, 8) \
+    X(HOTCUE_H_R, 0x21, 0, 8) \
+    X(HOTCUE_H_G, 0x22, 0, 8) \
+    X(HOTCUE_H_B, 0x23, 0, 8) \
+    X(SD_R, 0x24, 0, 8) \
+    X(SD_G, 0x25, 0, 8) \
+    X(SD_B, 0x26, 0, 8) \
+    X(USB_R, 0x27, 0, 8) \
+    X(USB_G, 0x28, 0, 8) \
+    X(USB_B, 0x29, 0, 8) \
+    X(MEDIA_COLOR_R, 0x2A, 0, 8) \
+    X(MEDIA_COLOR_G, 0x2B, 0, 8) \
+    X(MEDIA_COLOR_B, 0x2C, 0, 8)
+
+#endif /* __PROTOCOL_H_ */
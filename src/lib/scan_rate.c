@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom adaptive scan rate
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scan_rate.h"
+#include "subucom.h"
+
+static int64_t monotonic_millis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int scan_rate_init(scan_rate_t* rate, const int* steps_ms, uint8_t num_steps, int idle_ms) {
+    if (num_steps == 0 || num_steps > SCAN_RATE_MAX_STEPS) {
+        fprintf(stderr, "scan_rate: Invalid number of steps %d\n", num_steps);
+        return -1;
+    }
+
+    memset(rate, 0, sizeof(scan_rate_t));
+    memcpy(rate->steps_ms, steps_ms, num_steps * sizeof(int));
+    rate->num_steps = num_steps;
+    rate->idle_ms = idle_ms;
+
+    return 0;
+}
+
+/* parse a comma separated list of intervals, e.g. "2,10,50" */
+int scan_rate_parse_steps(scan_rate_t* rate, const char* str) {
+    int steps[SCAN_RATE_MAX_STEPS];
+    uint8_t num_steps = 0;
+    const char* p = str;
+
+    while (*p != '\0') {
+        char* end;
+        long val = strtol(p, &end, 10);
+
+        if (end == p || val <= 0 || num_steps == SCAN_RATE_MAX_STEPS) {
+            fprintf(stderr, "scan_rate: Invalid scan rate list '%s'\n", str);
+            return -1;
+        }
+        if (num_steps > 0 && val < steps[num_steps - 1]) {
+            fprintf(stderr, "scan_rate: Scan rates must be listed fastest first\n");
+            return -1;
+        }
+        steps[num_steps++] = (int)val;
+
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            fprintf(stderr, "scan_rate: Invalid scan rate list '%s'\n", str);
+            return -1;
+        }
+    }
+
+    return scan_rate_init(rate, steps, num_steps, rate->idle_ms);
+}
+
+void scan_rate_start(scan_rate_t* rate, subucom_t* subucom) {
+    rate->_step = 0;
+    rate->_last_change_ms = monotonic_millis();
+    subucom_start_timer(subucom, rate->steps_ms[0]);
+}
+
+/* call once after every subucom_read() */
+void scan_rate_update(scan_rate_t* rate, subucom_t* subucom) {
+    if (rate->num_steps < 2 || rate->idle_ms <= 0) {
+        return;
+    }
+
+    int64_t now = monotonic_millis();
+
+    if (subucom->frame_changed) {
+        rate->_last_change_ms = now;
+        if (rate->_step != 0) {
+            PRINT("scan_rate: active, %d ms\n", rate->steps_ms[0]);
+            rate->_step = 0;
+            subucom_start_timer(subucom, rate->steps_ms[0]);
+        }
+        return;
+    }
+
+    int64_t idle_steps = (now - rate->_last_change_ms) / rate->idle_ms;
+    if (idle_steps > rate->num_steps - 1) {
+        idle_steps = rate->num_steps - 1;
+    }
+
+    if (idle_steps > rate->_step) {
+        rate->_step = (uint8_t)idle_steps;
+        PRINT("scan_rate: idle, %d ms\n", rate->steps_ms[rate->_step]);
+        subucom_start_timer(subucom, rate->steps_ms[rate->_step]);
+    }
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom adaptive scan rate
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __SCAN_RATE_H_
+#define __SCAN_RATE_H_
+
+#include <stdint.h>
+
+#include "subucom.h"
+
+#define SCAN_RATE_MAX_STEPS  8
+
+/*
+ * Scan rate policy on top of subucom_start_timer(). The timer runs at
+ * steps_ms[0] while the controls are in use. After idle_ms without a
+ * changed frame it drops to the next (slower) step, and one step further
+ * for every additional idle_ms. The first changed frame brings it straight
+ * back to steps_ms[0].
+ */
+typedef struct scan_rate {
+    int         steps_ms[SCAN_RATE_MAX_STEPS];  /* fastest first */
+    uint8_t     num_steps;
+    int         idle_ms;                        /* 0 disables stepping down */
+
+    uint8_t     _step;
+    int64_t     _last_change_ms;
+} scan_rate_t;
+
+int  scan_rate_init(scan_rate_t* rate, const int* steps_ms, uint8_t num_steps, int idle_ms);
+int  scan_rate_parse_steps(scan_rate_t* rate, const char* str);
+void scan_rate_start(scan_rate_t* rate, subucom_t* subucom);
+void scan_rate_update(scan_rate_t* rate, subucom_t* subucom);
+
+#endif /* __SCAN_RATE_H_ */
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom shared memory state
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <linux/futex.h>
+
+#include "shm_state.h"
+
+/* same decoding as subucom_get_state(), undocumented button bits masked */
+static void decode(subucom_shm_decoded_t* decoded, const uint8_t* frame) {
+    subucom_state_t state;
+    subucom_state_decode(&state, frame, SUBUCOM_STATE_ALL);
+
+    decoded->buttons = state.buttons;
+    decoded->rotary_pos = state.rotary_pos;
+    decoded->touch_x = state.touch_x;
+    decoded->touch_y = state.touch_y;
+    decoded->tempo_slider = state.tempo_slider;
+    decoded->jog_pos = state.jog_pos;
+    decoded->jog_speed = state.jog_speed;
+    decoded->jog_flags = state.jog_flags;
+    decoded->slip_paddle = state.slip_paddle;
+    decoded->major_revision = state.major_revision;
+    decoded->minor_revision = state.minor_revision;
+}
+
+static int64_t monotonic_nanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int map_region(subucom_shm_t* shm, int fd) {
+    void* ptr = mmap(NULL, sizeof(subucom_shm_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED) {
+        fprintf(stderr, "subucom_shm: mmap failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    shm->region = (subucom_shm_region_t *)ptr;
+    return 0;
+}
+
+int subucom_shm_create(subucom_shm_t* shm, const char* name) {
+    shm->name = (name != NULL) ? name : SUBUCOM_SHM_NAME;
+
+    int fd = shm_open(shm->name, O_RDWR | O_CREAT | O_CLOEXEC, SUBUCOM_SHM_MODE);
+    if (fd < 0) {
+        fprintf(stderr, "subucom_shm: Error creating %s: %s\n", shm->name, strerror(errno));
+        return -1;
+    }
+
+    /* regardless of the umask, and of the mode a previous run left */
+    if (fchmod(fd, SUBUCOM_SHM_MODE) != 0) {
+        fprintf(stderr, "subucom_shm: Error setting the mode of %s: %s\n", shm->name, strerror(errno));
+    }
+
+    if (ftruncate(fd, sizeof(subucom_shm_region_t)) != 0) {
+        fprintf(stderr, "subucom_shm: Error sizing %s: %s\n", shm->name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (map_region(shm, fd) != 0) {
+        return -1;
+    }
+
+    /*
+     * The region outlives the publisher, so readers keep working across
+     * daemon restarts and seq never goes back.
+     */
+    subucom_shm_region_t* region = shm->region;
+    region->seq &= ~1u;
+    region->magic = SUBUCOM_SHM_MAGIC;
+    region->version = SUBUCOM_SHM_VERSION;
+
+    return 0;
+}
+
+void subucom_shm_publish(subucom_shm_t* shm, const uint8_t* frame, int64_t t_us) {
+    subucom_shm_region_t* region = shm->region;
+    uint32_t seq = region->seq;
+
+    __atomic_store_n(&region->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    region->t_us = t_us;
+    memcpy(region->frame, frame, SUBUCOM_BUFSIZE);
+    decode(&region->decoded, frame);
+
+    __atomic_store_n(&region->seq, seq + 2, __ATOMIC_RELEASE);
+
+    /*
+     * The futex syscall is only needed if somebody is blocked. The fence
+     * keeps the waiters load from moving before the seq store; paired with
+     * the one in subucom_shm_wait() either we see the waiter or it sees
+     * the new seq, so no wakeup is missed.
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&region->waiters, __ATOMIC_RELAXED) != 0) {
+        syscall(SYS_futex, &region->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+int subucom_shm_open(subucom_shm_t* shm, const char* name) {
+    shm->name = (name != NULL) ? name : SUBUCOM_SHM_NAME;
+
+    int fd = shm_open(shm->name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "subucom_shm: Error opening %s: %s\n", shm->name, strerror(errno));
+        return -1;
+    }
+
+    if (map_region(shm, fd) != 0) {
+        return -1;
+    }
+
+    if (shm->region->magic != SUBUCOM_SHM_MAGIC || shm->region->version != SUBUCOM_SHM_VERSION) {
+        fprintf(stderr, "subucom_shm: %s has an unknown layout\n", shm->name);
+        subucom_shm_close(shm);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* lock-free consistent copy of the latest frame, returns its sequence number */
+uint32_t subucom_shm_read(const subucom_shm_t* shm, subucom_shm_snapshot_t* snapshot) {
+    const subucom_shm_region_t* region = shm->region;
+    uint32_t seq1, seq2;
+
+    do {
+        seq1 = __atomic_load_n(&region->seq, __ATOMIC_ACQUIRE);
+        if (seq1 & 1) {
+            continue;
+        }
+
+        snapshot->t_us = region->t_us;
+        memcpy(snapshot->frame, region->frame, SUBUCOM_BUFSIZE);
+        snapshot->decoded = region->decoded;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq2 = __atomic_load_n(&region->seq, __ATOMIC_RELAXED);
+    } while ((seq1 & 1) || seq1 != seq2);
+
+    snapshot->seq = seq1;
+    return seq1;
+}
+
+/*
+ * Block until a frame newer than seq is published. Returns 0 when there is
+ * one, -1 on timeout (timeout_ms < 0 waits forever).
+ */
+int subucom_shm_wait(subucom_shm_t* shm, uint32_t seq, int timeout_ms) {
+    subucom_shm_region_t* region = shm->region;
+    int64_t deadline = monotonic_nanos() + (int64_t)timeout_ms * 1000000;
+    struct timespec ts;
+    int ret = 0;
+
+    __atomic_add_fetch(&region->waiters, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    while (1) {
+        uint32_t cur = __atomic_load_n(&region->seq, __ATOMIC_ACQUIRE);
+        if (cur != seq && !(cur & 1)) {
+            break;
+        }
+
+        /* FUTEX_WAIT takes a relative timeout, so EINTR and spurious wakes retry with what is left */
+        if (timeout_ms >= 0) {
+            int64_t remaining = deadline - monotonic_nanos();
+            if (remaining <= 0) {
+                ret = -1;
+                break;
+            }
+            ts.tv_sec = remaining / 1000000000;
+            ts.tv_nsec = remaining % 1000000000;
+        }
+
+        /* sleeps only while seq still holds the value we read */
+        if (syscall(SYS_futex, &region->seq, FUTEX_WAIT, cur, timeout_ms < 0 ? NULL : &ts, NULL, 0) != 0 &&
+            errno == ETIMEDOUT) {
+            ret = -1;
+            break;
+        }
+    }
+
+    __atomic_sub_fetch(&region->waiters, 1, __ATOMIC_ACQ_REL);
+
+    return ret;
+}
+
+void subucom_shm_close(subucom_shm_t* shm) {
+    munmap(shm->region, sizeof(subucom_shm_region_t));
+    shm->region = NULL;
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom shared memory state
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __SHM_STATE_H_
+#define __SHM_STATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "subucom.h"
+
+#define SUBUCOM_SHM_NAME     "/subucom_state"
+#define SUBUCOM_SHM_MAGIC    0x43425553  /* "SUBC" */
+#define SUBUCOM_SHM_VERSION  2
+
+/*
+ * Readers map the region read-write to count themselves in waiters, so it
+ * is shared with the publisher's group: run readers in that group.
+ */
+#define SUBUCOM_SHM_MODE     0660
+
+/* frequently used fields, decoded once by the publisher */
+typedef struct subucom_shm_decoded {
+    uint64_t buttons;           /* bytes 5-12, bit (byte - 5) * 8 + bit */
+    uint16_t rotary_pos;
+    uint16_t touch_x;
+    uint16_t touch_y;
+    uint16_t tempo_slider;
+    uint16_t jog_pos;
+    uint16_t jog_speed;
+    uint8_t  jog_flags;
+    uint8_t  slip_paddle;
+    uint8_t  major_revision;
+    uint8_t  minor_revision;
+} subucom_shm_decoded_t;
+
+typedef struct subucom_shm_snapshot {
+    uint32_t seq;
+    int64_t  t_us;              /* CLOCK_MONOTONIC time the frame was read */
+    uint8_t  frame[SUBUCOM_BUFSIZE];
+    subucom_shm_decoded_t decoded;
+} subucom_shm_snapshot_t;
+
+/*
+ * Shared region, published by the process owning the subucom device.
+ * seq is a seqlock: odd while the publisher is writing, and bumped by two
+ * for every published frame. It doubles as the futex word readers wait on.
+ */
+typedef struct subucom_shm_region {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t waiters;           /* readers blocked in subucom_shm_wait() */
+    int64_t  t_us;
+    uint8_t  frame[SUBUCOM_BUFSIZE];
+    subucom_shm_decoded_t decoded;
+} subucom_shm_region_t;
+
+typedef struct subucom_shm {
+    subucom_shm_region_t* region;
+    const char*           name;
+} subucom_shm_t;
+
+/* publisher */
+int  subucom_shm_create(subucom_shm_t* shm, const char* name);
+void subucom_shm_publish(subucom_shm_t* shm, const uint8_t* frame, int64_t t_us);
+
+/* readers */
+int      subucom_shm_open(subucom_shm_t* shm, const char* name);
+uint32_t subucom_shm_read(const subucom_shm_t* shm, subucom_shm_snapshot_t* snapshot);
+int      subucom_shm_wait(subucom_shm_t* shm, uint32_t seq, int timeout_ms);
+
+void subucom_shm_close(subucom_shm_t* shm);
+
+#endif /* __SHM_STATE_H_ */
@@ -0,0 +1,475 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom event sinks
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "sink.h"
+
+#define QUEUE_MASK  (SINK_QUEUE_SIZE - 1)
+
+#define OWED(bits, code)    ((bits)[(code) / 8] & (1 << ((code) % 8)))
+#define SET_OWED(bits, code)    ((bits)[(code) / 8] |= (1 << ((code) % 8)))
+#define CLEAR_OWED(bits, code)  ((bits)[(code) / 8] &= ~(1 << ((code) % 8)))
+
+static int64_t monotonic_millis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool backed_up(const sink_t* sink) {
+    return sink->head != sink->tail || sink->num_owed > 0;
+}
+
+static bool is_owed(const sink_t* sink, int code) {
+    return OWED(sink->owe_release, code) || OWED(sink->owe_press, code);
+}
+
+/*
+ * A write error loses the event. Sinks on their own fd (stream, socket
+ * client) are gone for good then and get removed; returns true if so.
+ */
+static bool write_failed(sink_t* sink) {
+    if (sink->own_fd) {
+        fprintf(stderr, "sink: %s: %s, removing\n", sink->name, strerror(errno));
+        sink_remove(sink);
+        return true;
+    }
+    sink->dropped++;
+    return false;
+}
+
+static void handle_ready(int fd, short revents, void* ctx);
+
+/* poll for POLLOUT only while there is a backlog */
+static void update_armed(sink_t* sink) {
+    bool backlog = backed_up(sink);
+
+    if (backlog && !sink->armed) {
+        /* if no slot is free, the backlog goes out with the next event instead */
+        if (subucom_watch_fd(sink->set->subucom, sink->poll_fd, POLLOUT, handle_ready, sink) == 0) {
+            sink->armed = true;
+        }
+    } else if (!backlog && sink->armed) {
+        subucom_unwatch_fd(sink->set->subucom, sink->poll_fd);
+        sink->armed = false;
+    }
+}
+
+/* write out the queue, then the owed key states; 1 once empty, -1 if removed */
+static int drain(sink_t* sink) {
+    while (sink->head != sink->tail) {
+        int ret = sink->write(sink, &sink->queue[sink->head & QUEUE_MASK]);
+        if (ret == 0) {
+            return 0;
+        }
+        if (ret < 0 && write_failed(sink)) {
+            return -1;
+        }
+        sink->head++;
+    }
+
+    for (int code = 0; sink->num_owed > 0 && code < KEY_CNT; code++) {
+        sink_event_t ev = { .t_us = sink->owed_t_us, .type = EV_KEY, .code = code };
+
+        /* the release first, a press owed after it is the final state */
+        if (OWED(sink->owe_release, code)) {
+            ev.value = 0;
+            int ret = sink->write(sink, &ev);
+            if (ret == 0) {
+                return 0;
+            }
+            if (ret < 0 && write_failed(sink)) {
+                return -1;
+            }
+            CLEAR_OWED(sink->owe_release, code);
+            if (!OWED(sink->owe_press, code)) {
+                sink->num_owed--;
+            }
+        }
+        if (OWED(sink->owe_press, code)) {
+            ev.value = 1;
+            int ret = sink->write(sink, &ev);
+            if (ret == 0) {
+                return 0;
+            }
+            if (ret < 0 && write_failed(sink)) {
+                return -1;
+            }
+            CLEAR_OWED(sink->owe_press, code);
+            sink->num_owed--;
+        }
+    }
+
+    return 1;
+}
+
+static void handle_ready(int fd, short revents, void* ctx) {
+    sink_t* sink = (sink_t *)ctx;
+
+    if (drain(sink) >= 0) {
+        update_armed(sink);
+    }
+}
+
+/* drop the repeats from the queue to make room, returns how many */
+static uint32_t merge_repeats(sink_t* sink) {
+    uint32_t out = sink->head;
+    for (uint32_t i = sink->head; i != sink->tail; i++) {
+        const sink_event_t* ev = &sink->queue[i & QUEUE_MASK];
+        if (ev->type == EV_KEY && ev->value == 2) {
+            continue;
+        }
+        sink->queue[out++ & QUEUE_MASK] = *ev;
+    }
+
+    uint32_t merged = sink->tail - out;
+    sink->tail = out;
+    sink->merged += merged;
+    return merged;
+}
+
+/* keep only the final state of a key that didn't fit in the queue */
+static void owe_key(sink_t* sink, const sink_event_t* ev) {
+    int code = ev->code;
+
+    if (ev->value == 2) {
+        sink->merged++;
+        return;
+    }
+
+    if (!is_owed(sink, code)) {
+        sink->num_owed++;
+    }
+    if (ev->value == 0) {
+        if (OWED(sink->owe_press, code)) {
+            CLEAR_OWED(sink->owe_press, code);
+            sink->merged++;
+        }
+        SET_OWED(sink->owe_release, code);
+    } else {
+        SET_OWED(sink->owe_press, code);
+    }
+    sink->owed_t_us = ev->t_us;
+}
+
+/* returns -1 if the sink was removed */
+static int emit(sink_t* sink, const sink_event_t* ev) {
+    bool key = (ev->type == EV_KEY && ev->code < KEY_CNT);
+
+    /* later events of an owed key must not overtake it */
+    if (key && is_owed(sink, ev->code)) {
+        owe_key(sink, ev);
+        return 0;
+    }
+
+    if (sink->head == sink->tail) {
+        int ret = sink->write(sink, ev);
+        if (ret > 0) {
+            return 0;
+        }
+        if (ret < 0) {
+            return write_failed(sink) ? -1 : 0;
+        }
+    }
+
+    if (sink->tail - sink->head == SINK_QUEUE_SIZE) {
+        if (key && ev->value == 2) {
+            sink->merged++;
+            return 0;
+        }
+        if (merge_repeats(sink) == 0) {
+            if (key) {
+                owe_key(sink, ev);
+            } else {
+                sink->dropped++;
+            }
+            return 0;
+        }
+    }
+
+    sink->queue[sink->tail++ & QUEUE_MASK] = *ev;
+    return 0;
+}
+
+void sink_set_init(sink_set_t* set, subucom_t* subucom) {
+    set->subucom = subucom;
+    set->num_sinks = 0;
+}
+
+void sink_set_deinit(sink_set_t* set) {
+    while (set->num_sinks > 0) {
+        sink_remove(set->sinks[set->num_sinks - 1]);
+    }
+}
+
+/*
+ * Send events to fd through write, which must not block: fd is left as it
+ * is, see sink_open_stream(). With own_fd it is closed along with the sink,
+ * including on a write error.
+ */
+sink_t* sink_add(sink_set_t* set, const char* name, int fd, bool own_fd, sink_write_fn_t write, void* ctx) {
+    if (set->num_sinks >= SINK_MAX) {
+        fprintf(stderr, "sink: Too many sinks\n");
+        return NULL;
+    }
+
+    sink_t* sink = calloc(1, sizeof(sink_t));
+    if (sink == NULL) {
+        fprintf(stderr, "sink: Out of memory\n");
+        return NULL;
+    }
+
+    /* a separate fd to poll, so the watch never clashes with others on fd */
+    sink->poll_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (sink->poll_fd < 0) {
+        fprintf(stderr, "sink: Error duplicating fd for %s: %s\n", name, strerror(errno));
+        free(sink);
+        return NULL;
+    }
+
+    struct stat st;
+    sink->is_socket = (fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode));
+
+    sink->name = name;
+    sink->fd = fd;
+    sink->write = write;
+    sink->ctx = ctx;
+    sink->own_fd = own_fd;
+    sink->set = set;
+    set->sinks[set->num_sinks++] = sink;
+
+    return sink;
+}
+
+/* safe to call from a write function or watch callback */
+void sink_remove(sink_t* sink) {
+    sink_set_t* set = sink->set;
+
+    if (sink->merged > 0 || sink->dropped > 0) {
+        fprintf(stderr, "sink: %s merged %llu and dropped %llu events\n", sink->name,
+                (unsigned long long)sink->merged, (unsigned long long)sink->dropped);
+    }
+
+    if (sink->armed) {
+        subucom_unwatch_fd(set->subucom, sink->poll_fd);
+    }
+    close(sink->poll_fd);
+    if (sink->own_fd) {
+        close(sink->fd);
+    }
+
+    for (int i = 0; i < set->num_sinks; i++) {
+        if (set->sinks[i] == sink) {
+            memmove(&set->sinks[i], &set->sinks[i + 1], (set->num_sinks - i - 1) * sizeof(sink_t *));
+            set->num_sinks--;
+            break;
+        }
+    }
+    free(sink);
+}
+
+/* hand an event to every sink, never blocks */
+void sink_set_emit(sink_set_t* set, int type, int code, int val, int64_t t_us) {
+    sink_event_t ev = { .t_us = t_us, .type = type, .code = code, .value = val };
+
+    for (int i = 0; i < set->num_sinks; ) {
+        sink_t* sink = set->sinks[i];
+        if (emit(sink, &ev) < 0) {
+            continue;
+        }
+        update_armed(sink);
+        i++;
+    }
+}
+
+/* wait up to timeout_ms for the backlogs to drain, e.g. before exiting */
+void sink_set_flush(sink_set_t* set, int timeout_ms) {
+    int64_t deadline = monotonic_millis() + timeout_ms;
+
+    while (1) {
+        struct pollfd fds[SINK_MAX];
+        nfds_t nfds = 0;
+
+        for (int i = 0; i < set->num_sinks; ) {
+            sink_t* sink = set->sinks[i];
+            int ret = drain(sink);
+            if (ret < 0) {
+                continue;
+            }
+            update_armed(sink);
+            if (ret == 0) {
+                fds[nfds].fd = sink->poll_fd;
+                fds[nfds].events = POLLOUT;
+                nfds++;
+            }
+            i++;
+        }
+
+        int64_t remaining = deadline - monotonic_millis();
+        if (nfds == 0 || remaining <= 0) {
+            break;
+        }
+        poll(fds, nfds, (int)remaining);
+    }
+}
+
+/*
+ * A new fd for writing to the stream on fd without blocking, and without
+ * making fd non-blocking for whoever else shares it (a tty, or the shell's
+ * pipe). Pipes and ttys are opened again through /proc for a file
+ * description of their own; sockets are written with MSG_DONTWAIT and
+ * regular files never block, those get a plain dup.
+ */
+int sink_open_stream(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "sink: Error on fd %d: %s\n", fd, strerror(errno));
+        return -1;
+    }
+
+    if (S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode)) {
+        char path[32];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+        int stream_fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (stream_fd < 0) {
+            fprintf(stderr, "sink: Error reopening %s: %s\n", path, strerror(errno));
+        }
+        return stream_fd;
+    }
+
+    return fcntl(fd, F_DUPFD_CLOEXEC, 0);
+}
+
+static int write_stream(sink_t* sink, const void* buf, size_t len) {
+    ssize_t n = sink->is_socket ? send(sink->fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL)
+                                : write(sink->fd, buf, len);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    /* pipes take up to PIPE_BUF bytes whole or not at all */
+    return 1;
+}
+
+/* one JSON object per line */
+int sink_write_json(sink_t* sink, const sink_event_t* ev) {
+    char line[96];
+    int len = snprintf(line, sizeof(line), "{\"t_us\":%lld,\"type\":%u,\"code\":%u,\"value\":%d}\n",
+                       (long long)ev->t_us, ev->type, ev->code, ev->value);
+    return write_stream(sink, line, len);
+}
+
+/* sink_event_t as is, in host byte order */
+int sink_write_binary(sink_t* sink, const sink_event_t* ev) {
+    return write_stream(sink, ev, sizeof(*ev));
+}
+
+static int write_client(sink_t* sink, const sink_event_t* ev) {
+    sink_server_t* server = (sink_server_t *)sink->ctx;
+
+    if (send(sink->fd, ev, sizeof(*ev), MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(*ev)) {
+        return 1;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0;
+    }
+
+    /* the client went away, the sink is removed by the caller */
+    for (int i = 0; i < SINK_SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i] == sink) {
+            server->clients[i] = NULL;
+        }
+    }
+    return -1;
+}
+
+static void handle_accept(int fd, short revents, void* ctx) {
+    sink_server_t* server = (sink_server_t *)ctx;
+
+    int client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd < 0) {
+        return;
+    }
+
+    for (int i = 0; i < SINK_SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i] != NULL) {
+            continue;
+        }
+
+        server->clients[i] = sink_add(server->set, "event socket client", client_fd, true, write_client, server);
+        if (server->clients[i] == NULL) {
+            break;
+        }
+        return;
+    }
+
+    fprintf(stderr, "sink_server: Too many clients\n");
+    close(client_fd);
+}
+
+/* every client connected to path gets the events as sink_event_t messages */
+int sink_server_init(sink_server_t* server, sink_set_t* set, const char* path) {
+    server->set = set;
+    for (int i = 0; i < SINK_SERVER_MAX_CLIENTS; i++) {
+        server->clients[i] = NULL;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "sink_server: Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    strcpy(server->path, path);
+
+    server->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->fd < 0) {
+        fprintf(stderr, "sink_server: Error creating socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    /* a stale socket from a previous run */
+    unlink(path);
+
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(server->fd, SINK_SERVER_MAX_CLIENTS) != 0) {
+        fprintf(stderr, "sink_server: Error listening on %s: %s\n", path, strerror(errno));
+        close(server->fd);
+        return -1;
+    }
+
+    if (subucom_watch_fd(set->subucom, server->fd, POLLIN, handle_accept, server) != 0) {
+        sink_server_deinit(server);
+        return -1;
+    }
+
+    return 0;
+}
+
+void sink_server_deinit(sink_server_t* server) {
+    for (int i = 0; i < SINK_SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i] != NULL) {
+            sink_remove(server->clients[i]);
+            server->clients[i] = NULL;
+        }
+    }
+
+    subucom_unwatch_fd(server->set->subucom, server->fd);
+    close(server->fd);
+    unlink(server->path);
+}
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom event sinks
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __SINK_H_
+#define __SINK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/un.h>
+#include <linux/input.h>
+
+#include "subucom.h"
+
+#define SINK_MAX                8
+#define SINK_QUEUE_SIZE         128     /* events, power of two */
+#define SINK_FLUSH_TIMEOUT_MS   500
+
+#define SINK_SERVER_PATH        "/run/subucom_events.sock"
+#define SINK_SERVER_MAX_CLIENTS 4
+
+/*
+ * One input event as queued, and as sent on the binary stream and the event
+ * socket (one SOCK_SEQPACKET message per event). t_us is the CLOCK_MONOTONIC
+ * arrival time of the frame.
+ */
+typedef struct sink_event {
+    int64_t  t_us;
+    uint16_t type;
+    uint16_t code;
+    int32_t  value;
+} sink_event_t;
+
+struct sink;
+struct sink_set;
+
+/* returns 1 once ev is written, 0 if fd would block and -1 on error */
+typedef int (*sink_write_fn_t)(struct sink* sink, const sink_event_t* ev);
+
+/*
+ * Every sink has its own queue, drained whenever its fd takes more, so a
+ * slow consumer only ever delays itself. When the queue is full, repeats are
+ * merged away first; key presses and releases that still don't fit are kept
+ * as the final state of each key and sent once the queue has drained, so no
+ * release is ever lost.
+ */
+typedef struct sink {
+    const char*      name;
+    int              fd;
+    sink_write_fn_t  write;
+    void*            ctx;
+    bool             own_fd;            /* closed by sink_remove() */
+    bool             is_socket;         /* stream written with MSG_DONTWAIT */
+    struct sink_set* set;
+
+    sink_event_t     queue[SINK_QUEUE_SIZE];
+    uint32_t         head;
+    uint32_t         tail;
+
+    uint8_t          owe_release[KEY_CNT / 8];  /* overflowed, sent after the queue */
+    uint8_t          owe_press[KEY_CNT / 8];
+    uint32_t         num_owed;
+    int64_t          owed_t_us;
+
+    int              poll_fd;           /* dup of fd, polled for POLLOUT while backed up */
+    bool             armed;
+
+    uint64_t         merged;            /* repeats dropped, or presses folded into a release */
+    uint64_t         dropped;           /* lost to write errors */
+} sink_t;
+
+typedef struct sink_set {
+    subucom_t*       subucom;
+    sink_t*          sinks[SINK_MAX];
+    int              num_sinks;
+} sink_set_t;
+
+typedef struct sink_server {
+    int              fd;
+    char             path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    sink_set_t*      set;
+    sink_t*          clients[SINK_SERVER_MAX_CLIENTS];
+} sink_server_t;
+
+void    sink_set_init(sink_set_t* set, subucom_t* subucom);
+void    sink_set_deinit(sink_set_t* set);
+sink_t* sink_add(sink_set_t* set, const char* name, int fd, bool own_fd, sink_write_fn_t write, void* ctx);
+void    sink_remove(sink_t* sink);
+void    sink_set_emit(sink_set_t* set, int type, int code, int val, int64_t t_us);
+void    sink_set_flush(sink_set_t* set, int timeout_ms);
+
+/* writers for a stream fd, e.g. stdout as opened by sink_open_stream() */
+int     sink_open_stream(int fd);
+int     sink_write_json(sink_t* sink, const sink_event_t* ev);
+int     sink_write_binary(sink_t* sink, const sink_event_t* ev);
+
+int     sink_server_init(sink_server_t* server, sink_set_t* set, const char* path);
+void    sink_server_deinit(sink_server_t* server);
+
+#endif /* __SINK_H_ */
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom decoded controller state
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <string.h>
+
+#include "state.h"
+
+/* every 1 bit field in the button bytes */
+#define BUTTON_BIT(name, byte, shift, width) \
+    | (((width) == 1 && (byte) >= SUBUCOM_IN_PLAY_BYTE && (byte) < SUBUCOM_IN_PLAY_BYTE + 8) \
+       ? 1ull << (((byte) - SUBUCOM_IN_PLAY_BYTE) * 8 + (shift)) : 0)
+
+static const uint64_t button_bits = 0 SUBUCOM_IN_FIELDS(BUTTON_BIT);
+
+/* frame bytes of each field group, in SUBUCOM_STATE_* bit order */
+static const struct {
+    uint8_t byte;
+    uint8_t len;
+} field_bytes[] = {
+    { SUBUCOM_IN_PLAY_BYTE,               8 },
+    { SUBUCOM_IN_SLIP_PADDLE_BYTE,        1 },
+    { SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE, 2 },
+    { SUBUCOM_IN_TOUCHSCREEN_X_BYTE,      4 },
+    { SUBUCOM_IN_TEMPO_SLIDER_POS_BYTE,   2 },
+    { SUBUCOM_IN_VINYL_SPEED_POS_BYTE,    2 },
+    { SUBUCOM_IN_JOG_POS_BYTE,            5 },
+    { SUBUCOM_IN_MAJOR_REVISION_BYTE,     2 },
+};
+
+_Static_assert(SUBUCOM_IN_TOUCHSCREEN_Y_BYTE == SUBUCOM_IN_TOUCHSCREEN_X_BYTE + 2, "touch X/Y not adjacent");
+_Static_assert(SUBUCOM_IN_JOG_PRESS_BYTE == SUBUCOM_IN_JOG_POS_BYTE + 4, "jog fields not adjacent");
+_Static_assert(SUBUCOM_IN_MINOR_REVISION_BYTE == SUBUCOM_IN_MAJOR_REVISION_BYTE + 1, "revision not adjacent");
+
+static uint16_t be16(const uint8_t* frame, int byte) {
+    return ((uint16_t)frame[byte] << 8) | frame[byte + 1];
+}
+
+static uint64_t buttons(const uint8_t* frame) {
+    uint64_t buttons = 0;
+    for (int i = 0; i < 8; i++) {
+        buttons |= (uint64_t)frame[SUBUCOM_IN_PLAY_BYTE + i] << (i * 8);
+    }
+    return buttons & button_bits;
+}
+
+/* decode the groups in fields from frame, they become valid */
+void subucom_state_decode(subucom_state_t* state, const uint8_t* frame, uint32_t fields) {
+    if (fields & SUBUCOM_STATE_BUTTONS) {
+        state->buttons = buttons(frame);
+    }
+    if (fields & SUBUCOM_STATE_SLIP_PADDLE) {
+        state->slip_paddle = frame[SUBUCOM_IN_SLIP_PADDLE_BYTE] & SUBUCOM_IN_SLIP_PADDLE_MASK;
+    }
+    if (fields & SUBUCOM_STATE_ROTARY) {
+        state->rotary_pos = be16(frame, SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE);
+    }
+    if (fields & SUBUCOM_STATE_TOUCH) {
+        state->touch_x = be16(frame, SUBUCOM_IN_TOUCHSCREEN_X_BYTE);
+        state->touch_y = be16(frame, SUBUCOM_IN_TOUCHSCREEN_Y_BYTE);
+    }
+    if (fields & SUBUCOM_STATE_TEMPO) {
+        state->tempo_slider = be16(frame, SUBUCOM_IN_TEMPO_SLIDER_POS_BYTE);
+    }
+    if (fields & SUBUCOM_STATE_VINYL_SPEED) {
+        state->vinyl_speed = be16(frame, SUBUCOM_IN_VINYL_SPEED_POS_BYTE);
+    }
+    if (fields & SUBUCOM_STATE_JOG) {
+        state->jog_pos = be16(frame, SUBUCOM_IN_JOG_POS_BYTE);
+        state->jog_speed = be16(frame, SUBUCOM_IN_JOG_SPEED_BYTE);
+        state->jog_flags = frame[SUBUCOM_IN_JOG_PRESS_BYTE];
+    }
+    if (fields & SUBUCOM_STATE_REVISION) {
+        state->major_revision = frame[SUBUCOM_IN_MAJOR_REVISION_BYTE];
+        state->minor_revision = frame[SUBUCOM_IN_MINOR_REVISION_BYTE];
+    }
+    state->valid |= fields;
+}
+
+/* the groups of fields whose bytes differ between the two frames */
+uint32_t subucom_state_changed(const uint8_t* frame, const uint8_t* prev_frame, uint32_t fields) {
+    uint32_t changed = 0;
+
+    /* undocumented bits next to the buttons don't count */
+    if (fields & SUBUCOM_STATE_BUTTONS) {
+        if (buttons(frame) != buttons(prev_frame)) {
+            changed |= SUBUCOM_STATE_BUTTONS;
+        }
+        fields &= ~SUBUCOM_STATE_BUTTONS;
+    }
+
+    while (fields != 0) {
+        int i = __builtin_ctz(fields);
+        fields &= fields - 1;
+
+        if (i < (int)(sizeof(field_bytes) / sizeof(field_bytes[0])) &&
+            memcmp(frame + field_bytes[i].byte, prev_frame + field_bytes[i].byte, field_bytes[i].len) != 0) {
+            changed |= 1u << i;
+        }
+    }
+
+    return changed;
+}
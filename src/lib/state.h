@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom decoded controller state
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __STATE_H_
+#define __STATE_H_
+
+#include <stdint.h>
+
+#include "protocol.h"
+
+/* field groups of subucom_state_t, decoded and watched together */
+#define SUBUCOM_STATE_BUTTONS       (1u << 0)   /* buttons */
+#define SUBUCOM_STATE_SLIP_PADDLE   (1u << 1)   /* slip_paddle */
+#define SUBUCOM_STATE_ROTARY        (1u << 2)   /* rotary_pos */
+#define SUBUCOM_STATE_TOUCH         (1u << 3)   /* touch_x, touch_y */
+#define SUBUCOM_STATE_TEMPO         (1u << 4)   /* tempo_slider */
+#define SUBUCOM_STATE_VINYL_SPEED   (1u << 5)   /* vinyl_speed */
+#define SUBUCOM_STATE_JOG           (1u << 6)   /* jog_pos, jog_speed, jog_flags */
+#define SUBUCOM_STATE_REVISION      (1u << 7)   /* major/minor_revision */
+#define SUBUCOM_STATE_ALL           0xFFu
+
+/* bit of a button in subucom_state_t.buttons, name as in doc/subucom_fields.js */
+#define SUBUCOM_BUTTON(name) \
+    (1ull << ((SUBUCOM_IN_##name##_BYTE - SUBUCOM_IN_PLAY_BYTE) * 8 + __builtin_ctz(SUBUCOM_IN_##name##_MASK)))
+
+/*
+ * Typed view of one input frame. Only the groups in valid have been decoded
+ * from frame seq, see subucom_get_state().
+ */
+typedef struct subucom_state {
+    uint32_t seq;
+    uint32_t valid;
+
+    uint64_t buttons;           /* documented button bits only */
+    uint8_t  slip_paddle;
+    uint16_t rotary_pos;
+    uint16_t touch_x;
+    uint16_t touch_y;
+    uint16_t tempo_slider;
+    uint16_t vinyl_speed;
+    uint16_t jog_pos;
+    uint16_t jog_speed;
+    uint8_t  jog_flags;         /* SUBUCOM_IN_JOG_*_MASK */
+    uint8_t  major_revision;
+    uint8_t  minor_revision;
+} subucom_state_t;
+
+void     subucom_state_decode(subucom_state_t* state, const uint8_t* frame, uint32_t fields);
+uint32_t subucom_state_changed(const uint8_t* frame, const uint8_t* prev_frame, uint32_t fields);
+
+#endif /* __STATE_H_ */
@@ -15,15 +15,21 @@
 #include <stdlib.h>
 #include <poll.h>
 #include <sys/ioctl.h>
+#include <time.h>
 
 #include <linux/input.h>
 #include <linux/uinput.h>
 
 #include "subucom.h"
 #include "crc16.h"
+#include "trace.h"
 #include "uinput.h"
 
 
+/* the jog decoder reads all jog flags from one byte */
+_Static_assert(SUBUCOM_IN_JOG_PRESS_BYTE == SUBUCOM_IN_JOG_DIR_BYTE &&
+               SUBUCOM_IN_JOG_PRESS_BYTE == SUBUCOM_IN_JOG_MOVING_BYTE, "jog flags must share a byte");
+
 const char *default_subucom_device_path = "/dev/subucom_spi2.0";
 
 int subucom_init(subucom_t* subucom, const char *device_path) {
@@ -39,12 +45,44 @@ int subucom_init(subucom_t* subucom, const char *device_path) {
         return -1;
     }
 
+    return subucom_init_fd(subucom, fd);
+}
+
+/*
+ * Set up subucom on an already open fd. Anything delivering one 64 byte frame
+ * per read() works, e.g. a SOCK_SEQPACKET socket for testing without the
+ * device; ioctls the fd doesn't know are ignored.
+ */
+int subucom_init_fd(subucom_t* subucom, int fd) {
     subucom->_read_mode = REGULAR;
     subucom->fd = fd;
+
+    /* an empty message is a no-op for drivers that know the ioctl */
+    subucom->_has_ioc_message = (ioctl(fd, SUBUCOM_IOC_MESSAGE(0), NULL) == 0);
     subucom->fire_input_event_fn = NULL;
+    subucom->frame_changed = false;
+    subucom->major_revision = 0;
+    subucom->minor_revision = 0;
+    subucom->_layout = NULL;
+    subucom->_keymap = NULL;
+    subucom->_layer = NULL;
+    subucom->_layer_index = 0;
+    subucom->seq = 0;
+    subucom->t_us = 0;
+    memset(&subucom->_state, 0, sizeof(subucom->_state));
+    subucom->_num_state_watches = 0;
+    subucom->_state_interest = 0;
+    memset(&subucom->_history, 0, sizeof(subucom->_history));
+    memset(&subucom->_debounce, 0, sizeof(subucom->_debounce));
+    subucom->_wear = NULL;
 
     subucom->fds[0].fd = fd;
     subucom->fds[0].events = POLLIN;
+    subucom->nfds = 1;
+
+    memset(subucom->_leds, 0, LED_FRAME_SIZE);
+    memset(subucom->_leds_sent, 0, LED_FRAME_SIZE);
+    memset(subucom->_feedback_out, 0, sizeof(subucom->_feedback_out));
 
     uint8_t* ptr = (uint8_t *)malloc(SUBUCOM_BUFSIZE);
     if (ptr == NULL) {
@@ -52,7 +90,13 @@ int subucom_init(subucom_t* subucom, const char *device_path) {
     }
     subucom->_buf = ptr;
 
-    uint8_t* prev_ptr = (uint8_t *)malloc(SUBUCOM_BUFSIZE);
+    uint8_t* rx_ptr = (uint8_t *)malloc(SUBUCOM_BUFSIZE);
+    if (rx_ptr == NULL) {
+        return -1;
+    }
+    subucom->_rx_buf = rx_ptr;
+
+    uint8_t* prev_ptr = (uint8_t *)calloc(1, SUBUCOM_BUFSIZE);
     if (prev_ptr == NULL) {
         return -1;
     }
@@ -63,11 +107,125 @@ int subucom_init(subucom_t* subucom, const char *device_path) {
 
 int subucom_register_keymap(subucom_t* subucom, keymap_t* keymap, input_event_cb_t fire_input_event_cb) {
     subucom->_keymap = keymap;
+    subucom->_layer = keymap;
+    subucom->_layer_index = 0;
     subucom->fire_input_event_fn = fire_input_event_cb;
 
     return 0;
 } 
 
+/*
+ * Poll an additional fd from subucom_read() in POLLED mode. The callback runs
+ * before the next frame is read, so it can safely change the keymap or any
+ * other state the decoders use.
+ */
+int subucom_watch_fd(subucom_t* subucom, int fd, short events, poll_fd_cb_t cb, void* ctx) {
+    /* reuse a slot freed by subucom_unwatch_fd() first */
+    nfds_t i;
+    for (i = 1; i < subucom->nfds; i++) {
+        if (subucom->fds[i].fd < 0) {
+            break;
+        }
+    }
+
+    if (i == subucom->nfds) {
+        if (subucom->nfds >= SUBUCOM_MAX_POLL_FDS) {
+            fprintf(stderr, "subucom_watch_fd: Too many fds\n");
+            return -1;
+        }
+        subucom->nfds++;
+    }
+
+    subucom->fds[i].fd = fd;
+    subucom->fds[i].events = events;
+    subucom->fds[i].revents = 0;
+    subucom->_watches[i].fn = cb;
+    subucom->_watches[i].ctx = ctx;
+
+    return 0;
+}
+
+/*
+ * Stop polling fd. The slot is only marked free (poll() skips negative fds),
+ * so this is safe to call from a watch callback.
+ */
+void subucom_unwatch_fd(subucom_t* subucom, int fd) {
+    for (nfds_t i = 1; i < subucom->nfds; i++) {
+        if (subucom->fds[i].fd == fd) {
+            subucom->fds[i].fd = -1;
+            subucom->fds[i].revents = 0;
+            subucom->_watches[i].fn = NULL;
+        }
+    }
+}
+
+/*
+ * Call cb after every frame in which one of the SUBUCOM_STATE_* groups in
+ * fields changed. Frames are only compared on the groups somebody watches.
+ */
+int subucom_watch_state(subucom_t* subucom, uint32_t fields, state_cb_t cb, void* ctx) {
+    if (subucom->_num_state_watches >= SUBUCOM_MAX_STATE_WATCHES) {
+        fprintf(stderr, "subucom_watch_state: Too many watches\n");
+        return -1;
+    }
+
+    subucom_state_watch_t* watch = &subucom->_state_watches[subucom->_num_state_watches++];
+    watch->fields = fields;
+    watch->fn = cb;
+    watch->ctx = ctx;
+    subucom->_state_interest |= fields;
+
+    return 0;
+}
+
+/*
+ * Debounce every frame for frames[class] frames before decoding, see
+ * debounce.h. All zero turns debouncing off again.
+ */
+int subucom_set_debounce(subucom_t* subucom, const uint8_t frames[DEBOUNCE_NUM_CLASSES]) {
+    return debounce_init(&subucom->_debounce, frames);
+}
+
+/* count actuations of every validated frame into wear, NULL to stop */
+void subucom_count_wear(subucom_t* subucom, wear_counters_t* wear) {
+    subucom->_wear = wear;
+}
+
+/*
+ * Decode the requested SUBUCOM_STATE_* groups of the last valid frame. Groups
+ * are decoded on first use and kept until the next frame, other members of
+ * the returned state are stale.
+ */
+const subucom_state_t* subucom_get_state(subucom_t* subucom, uint32_t fields) {
+    subucom_state_t* state = &subucom->_state;
+
+    if (state->seq != subucom->seq) {
+        state->seq = subucom->seq;
+        state->valid = 0;
+    }
+
+    uint32_t missing = fields & ~state->valid;
+    if (missing != 0) {
+        subucom_state_decode(state, subucom->_buf, missing);
+    }
+
+    return state;
+}
+
+static void read_state_watches(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
+    uint32_t changed = subucom_state_changed(buffer, prev_buffer, subucom->_state_interest);
+    if (changed == 0) {
+        return;
+    }
+
+    for (int i=0; i<subucom->_num_state_watches; i++) {
+        const subucom_state_watch_t* watch = &subucom->_state_watches[i];
+        if (watch->fields & changed) {
+            watch->fn(subucom, watch->fields & changed, watch->ctx);
+        }
+    }
+}
+
 void subucom_stop_timer(subucom_t* subucom) {
     int val = 0;
     ioctl(subucom->fd, SUBUCOM_IOC_WR_TIMER_STATUS, &val);
@@ -103,6 +261,12 @@ int subucom_read_timer_interval(subucom_t* subucom)
     return val;    
 }
 
+static int64_t monotonic_micros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 static uint16_t be16_to_cpu_unsigned(const uint8_t data0, const uint8_t data1)
 {
     return ((uint16_t)data0 << 8) | (uint16_t)data1;
@@ -119,22 +283,40 @@ static int validate_checksum(uint8_t* buf) {
     return 0;
 }
 
+/* (re)write the CRC of a full frame */
+static void set_checksum(uint8_t* buffer) {
+    uint16_t crc16 = crc16_x25_calc(buffer, SUBUCOM_BUFSIZE-2);
+    uint8_t crch = (crc16 & 0xFF);
+    uint8_t crcl = (crc16 >> 8);
+
+    buffer[SUBUCOM_BUFSIZE-2] = crch;
+    buffer[SUBUCOM_BUFSIZE-1] = crcl;
+}
+
+/* pad buf to a full frame and append its CRC */
+static void make_frame(uint8_t* buffer, const uint8_t* buf, const uint8_t len) {
+    memcpy(buffer, buf, len);
+    memset(buffer+len, 0x0, SUBUCOM_BUFSIZE-len);
+    set_checksum(buffer);
+}
+
 inline static void fire_input_event(subucom_t* subucom, int type, int code, int val)
 {
     if (subucom->fire_input_event_fn != NULL) {
-        subucom->fire_input_event_fn(type, code, val);
+        TRACE3(decode, "type=%d code=%d val=%d", type, code, val);
+        subucom->fire_input_event_fn(type, code, val, subucom->t_us);
     }
 }
 
 static void read_jog(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer)
 {
-    const uint8_t MOVING = (1 << 3);
-    const uint8_t DIR = (1 << 2);
-    const uint8_t PRESS = (1 << 1);
+    const uint8_t MOVING = SUBUCOM_IN_JOG_MOVING_MASK;
+    const uint8_t DIR = SUBUCOM_IN_JOG_DIR_MASK;
+    const uint8_t PRESS = SUBUCOM_IN_JOG_PRESS_MASK;
 
-    uint8_t num_jogs = subucom->_keymap->num_jogs;
+    uint8_t num_jogs = subucom->_layer->num_jogs;
     for (int i=0; i<num_jogs; i++) {
-        jog_def_t jog = subucom->_keymap->jogs[i];
+        jog_def_t jog = subucom->_layer->jogs[i];
 
         uint8_t moving = buffer[jog.byte] & MOVING;
         uint8_t dir = buffer[jog.byte] & DIR;
@@ -191,41 +373,47 @@ static void read_jog(subucom_t* subucom, const uint8_t *buffer, const uint8_t *p
     }
 }
 
+/*
+ * A selector change is one release of the old state and one press of the
+ * new one, looked up through the selector's state index.
+ */
 static void read_selectors(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
-    uint8_t num_selectors = subucom->_keymap->num_selectors;
+    uint8_t num_selectors = subucom->_layer->num_selectors;
     for (int i=0; i<num_selectors; i++) {
-        selector_def_t selector = subucom->_keymap->selectors[i];
-        selector_state_t *states = selector.states;
-
-        uint8_t selector_state = buffer[selector.byte];
-        uint8_t selector_state_prev = prev_buffer[selector.byte];
-
-        for (int j; j<selector.state_count; j++) {
-            selector_state_t state = states[j];
-            if (state.as_button == true) {
-                if (selector_state != selector_state_prev) {
-                    if (selector_state == state.value) {
-                        PRINT("selector %d:%d pressed\n", selector.id, state.id);
-                        fire_input_event(subucom, EV_KEY, state.keycode, 1);
-                    } else {
-                        PRINT("selector %d:%d released\n", selector.id, state.id);
-                        fire_input_event(subucom, EV_KEY, state.keycode, 0);
-                    }
-                } else {
-                    if (selector_state == state.value) {
-                        PRINT("selector %d:%d repeat\n", selector.id, state.id);
-                        fire_input_event(subucom, EV_KEY, state.keycode, 2);
-                    }
-                }
+        const selector_def_t* selector = &subucom->_layer->selectors[i];
+
+        uint8_t selector_state = buffer[selector->byte] & selector->mask;
+        uint8_t selector_state_prev = prev_buffer[selector->byte] & selector->mask;
+
+        int8_t j = selector->state_index[selector_state];
+        const selector_state_t* state = (j >= 0) ? &selector->states[j] : NULL;
+
+        if (selector_state == selector_state_prev) {
+            if (state != NULL && state->as_button == true) {
+                PRINT("selector %d:%d repeat\n", selector->id, state->id);
+                fire_input_event(subucom, EV_KEY, state->keycode, 2);
             }
+            continue;
+        }
+
+        int8_t j_prev = selector->state_index[selector_state_prev];
+        const selector_state_t* state_prev = (j_prev >= 0) ? &selector->states[j_prev] : NULL;
+
+        if (state_prev != NULL && state_prev->as_button == true) {
+            PRINT("selector %d:%d released\n", selector->id, state_prev->id);
+            fire_input_event(subucom, EV_KEY, state_prev->keycode, 0);
+        }
+        if (state != NULL && state->as_button == true) {
+            PRINT("selector %d:%d pressed\n", selector->id, state->id);
+            fire_input_event(subucom, EV_KEY, state->keycode, 1);
         }
     }
 }
 
 static void read_buttons(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
-    uint8_t num_buttons = subucom->_keymap->num_buttons;
+    uint8_t num_buttons = subucom->_layer->num_buttons;
     for (int i=0; i<num_buttons; i++) {
-        button_def_t button = subucom->_keymap->buttons[i];
+        button_def_t button = subucom->_layer->buttons[i];
 
         uint8_t button_state = buffer[button.byte] & button.bit;
         uint8_t button_state_prev = prev_buffer[button.byte] & button.bit;
@@ -249,9 +437,9 @@ static void read_buttons(subucom_t* subucom, const uint8_t *buffer, const uint8_
 }
 
 static void read_encoders(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
-    uint8_t num_encoders = subucom->_keymap->num_encoders;
+    uint8_t num_encoders = subucom->_layer->num_encoders;
     for (int i=0; i<num_encoders; i++) {
-        encoder_def_t encoder = subucom->_keymap->encoders[i];
+        encoder_def_t encoder = subucom->_layer->encoders[i];
 
         int16_t encoder_value = be16_to_cpu_unsigned(buffer[encoder.byte], buffer[encoder.byte + 1]);
         int16_t encoder_value_prev = be16_to_cpu_unsigned(prev_buffer[encoder.byte], prev_buffer[encoder.byte + 1]);
@@ -272,26 +460,301 @@ static void read_encoders(subucom_t* subucom, const uint8_t *buffer, const uint8
     }
 }
 
+/* fire val for every key held in buffer according to keymap */
+static void fire_held(subucom_t* subucom, const keymap_t* keymap, const uint8_t *buffer, int val) {
+    const uint8_t MOVING = SUBUCOM_IN_JOG_MOVING_MASK;
+    const uint8_t DIR = SUBUCOM_IN_JOG_DIR_MASK;
+    const uint8_t PRESS = SUBUCOM_IN_JOG_PRESS_MASK;
+
+    for (int i=0; i<keymap->num_buttons; i++) {
+        const button_def_t* button = &keymap->buttons[i];
+        if ((buffer[button->byte] & button->bit) == button->bit) {
+            fire_input_event(subucom, EV_KEY, button->keycode, val);
+        }
+    }
+
+    for (int i=0; i<keymap->num_selectors; i++) {
+        const selector_def_t* selector = &keymap->selectors[i];
+        int8_t j = selector->state_index[buffer[selector->byte] & selector->mask];
+        if (j >= 0 && selector->states[j].as_button == true) {
+            fire_input_event(subucom, EV_KEY, selector->states[j].keycode, val);
+        }
+    }
+
+    for (int i=0; i<keymap->num_jogs; i++) {
+        const jog_def_t* jog = &keymap->jogs[i];
+        if (buffer[jog->byte] & PRESS) {
+            fire_input_event(subucom, EV_KEY, jog->button_keycode, val);
+        }
+        if (jog->dir_as_button == true && (buffer[jog->byte] & MOVING)) {
+            fire_input_event(subucom, EV_KEY, (buffer[jog->byte] & DIR) ? jog->right_keycode : jog->left_keycode, val);
+        }
+    }
+}
+
+/* turn off what the keymap's feedback has lit */
+static void clear_feedback(subucom_t* subucom, const keymap_t* keymap) {
+    for (int i=0; i<keymap->num_feedback; i++) {
+        if (subucom->_feedback_out[i] != 0) {
+            subucom_set_led(subucom, keymap->feedback[i].led, 0);
+            subucom->_feedback_out[i] = 0;
+        }
+    }
+}
+
+/*
+ * Replace the active keymap between two frames. Keys held under the old
+ * keymap are released and pressed again under the new one, so no key is left
+ * stuck. The caller owns (and frees) the old keymap.
+ */
+void subucom_swap_keymap(subucom_t* subucom, keymap_t* keymap) {
+    if (subucom->_layer != NULL) {
+        fire_held(subucom, subucom->_layer, subucom->_prev_buf, 0);
+        clear_feedback(subucom, subucom->_keymap);
+    }
+
+    subucom->_keymap = keymap;
+    subucom->_layer = keymap;
+    subucom->_layer_index = 0;
+
+    if (keymap != NULL) {
+        fire_held(subucom, keymap, subucom->_prev_buf, 1);
+    }
+}
+
+static void read_combos(subucom_t* subucom, const uint8_t *buffer) {
+    combo_set_t* combos = subucom->_keymap->combos;
+
+    uint32_t fired = combo_eval(combos, buffer, subucom->t_us / 1000);
+    while (fired != 0) {
+        int i = __builtin_ctz(fired);
+        fired &= fired - 1;
+
+        PRINT("combo %d fired\n", i);
+        fire_input_event(subucom, EV_KEY, combos->ids[i], 1);
+        fire_input_event(subucom, EV_KEY, combos->ids[i], 0);
+    }
+}
+
+/* the age'th newest edge of the history, 0 being the newest */
+const gesture_edge_t* subucom_history(const subucom_t* subucom, uint32_t age) {
+    return gesture_history_get(&subucom->_history, age);
+}
+
+/* record the button and rotary changes of a frame, returns their number */
+static int read_history(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
+    const uint8_t ROTARY = SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE;
+    gesture_edge_t edge = { .t_us = subucom->t_us };
+    int n = 0;
+
+    for (int i=SUBUCOM_IN_SLIP_PADDLE_BYTE; i<=SUBUCOM_IN_USB_STOP_BYTE; i++) {
+        if (buffer[i] != prev_buffer[i]) {
+            edge.byte = i;
+            edge.prev = prev_buffer[i];
+            edge.value = buffer[i];
+            gesture_history_push(&subucom->_history, &edge);
+            n++;
+        }
+    }
+
+    edge.prev = be16_to_cpu_unsigned(prev_buffer[ROTARY], prev_buffer[ROTARY + 1]);
+    edge.value = be16_to_cpu_unsigned(buffer[ROTARY], buffer[ROTARY + 1]);
+    if (edge.value != edge.prev) {
+        edge.byte = ROTARY;
+        gesture_history_push(&subucom->_history, &edge);
+        n++;
+    }
+
+    return n;
+}
+
+/* run the gestures over the new edges, recognized gestures tap their key */
+static void read_gestures(subucom_t* subucom, const uint8_t *buffer, int num_edges) {
+    gesture_set_t* gestures = subucom->_keymap->gestures;
+    int keycodes[GESTURE_MAX];
+    int n;
+
+    for (int age=num_edges - 1; age>=0; age--) {
+        const gesture_edge_t* edge = gesture_history_get(&subucom->_history, age);
+        n = gesture_edge(gestures, edge, buffer, keycodes, GESTURE_MAX);
+        for (int i=0; i<n; i++) {
+            PRINT("gesture key %d\n", keycodes[i]);
+            fire_input_event(subucom, EV_KEY, keycodes[i], 1);
+            fire_input_event(subucom, EV_KEY, keycodes[i], 0);
+        }
+    }
+
+    n = gesture_tick(gestures, subucom->t_us / 1000, keycodes, GESTURE_MAX);
+    for (int i=0; i<n; i++) {
+        PRINT("gesture key %d\n", keycodes[i]);
+        fire_input_event(subucom, EV_KEY, keycodes[i], 1);
+        fire_input_event(subucom, EV_KEY, keycodes[i], 0);
+    }
+}
+
+/*
+ * Fold the feedback table into the pending LED frame. An LED is only
+ * touched when its feedback level changes, so LEDs set by other means are
+ * left alone while the control is idle.
+ */
+static void read_feedback(subucom_t* subucom, const uint8_t *buffer) {
+    const keymap_t* keymap = subucom->_keymap;
+    int64_t now_ms = subucom->t_us / 1000;
+
+    for (int i=0; i<keymap->num_feedback; i++) {
+        const feedback_def_t* feedback = &keymap->feedback[i];
+        uint8_t level = 0;
+
+        if ((buffer[feedback->byte] & feedback->mask) == feedback->value) {
+            level = feedback->level;
+            if (feedback->blink_ms != 0 && (now_ms % feedback->blink_ms) >= feedback->blink_ms / 2) {
+                level = 0;
+            }
+        }
+
+        if (level != subucom->_feedback_out[i]) {
+            subucom_set_led(subucom, feedback->led, level);
+            subucom->_feedback_out[i] = level;
+        }
+    }
+}
+
+/*
+ * Track the layer switches and activate the resulting layer. Keys held in
+ * the old layer are released; controls still held are picked up by the new
+ * layer on their next press.
+ */
+static void read_layer_switches(subucom_t* subucom, const uint8_t *buffer, const uint8_t *prev_buffer) {
+    const keymap_t* keymap = subucom->_keymap;
+    uint8_t layer = subucom->_layer_index;
+
+    for (int i=0; i<keymap->num_layer_switches; i++) {
+        const layer_switch_def_t* layer_switch = &keymap->layer_switches[i];
+
+        uint8_t pressed = buffer[layer_switch->byte] & layer_switch->bit;
+        uint8_t pressed_prev = prev_buffer[layer_switch->byte] & layer_switch->bit;
+
+        if (pressed == pressed_prev) {
+            continue;
+        }
+
+        if (layer_switch->mode == LAYER_MOMENTARY) {
+            layer = pressed ? layer_switch->layer : 0;
+        } else if (pressed) {
+            layer = (layer == layer_switch->layer) ? 0 : layer_switch->layer;
+        }
+    }
+
+    if (layer != subucom->_layer_index) {
+        PRINT("layer %d -> %d\n", subucom->_layer_index, layer);
+        fire_held(subucom, subucom->_layer, prev_buffer, 0);
+        subucom->_layer = keymap->layers[layer];
+        subucom->_layer_index = layer;
+
+        /*
+         * Press what is still held on the new layer, so the repeats the
+         * decoders send for it follow a press. Edges of this frame are
+         * left to the decoders, as for subucom_swap_keymap().
+         */
+        fire_held(subucom, subucom->_layer, prev_buffer, 1);
+    }
+}
+
+/* pick the frame layout for the firmware revision, once */
+static void select_layout(subucom_t* subucom, const uint8_t *buffer) {
+    /* the revision bytes are at the same place in every layout */
+    subucom->major_revision = buffer[SUBUCOM_IN_MAJOR_REVISION_BYTE];
+    subucom->minor_revision = buffer[SUBUCOM_IN_MINOR_REVISION_BYTE];
+
+    subucom->_layout = subucom_layout_find(subucom->major_revision, subucom->minor_revision);
+    if (subucom->_layout == NULL) {
+        /*
+         * The revision the reference unit reports hasn't been recorded, so
+         * until some revision is characterized every unit is assumed to
+         * use the reference layout, without a warning.
+         */
+        if (subucom_layout_count() > 0) {
+            fprintf(stderr, "subucom: Unknown firmware revision %d.%d, assuming the %s layout\n",
+                    subucom->major_revision, subucom->minor_revision, subucom_layout_reference.name);
+        }
+        subucom->_layout = &subucom_layout_reference;
+    }
+}
+
+/* rearrange a frame of another layout into the reference layout */
+static void relayout(const subucom_layout_t* layout, uint8_t *buffer) {
+    uint8_t raw[SUBUCOM_BUFSIZE];
+    memcpy(raw, buffer, SUBUCOM_BUFSIZE);
+    for (int i = 0; i < SUBUCOM_BUFSIZE; i++) {
+        buffer[i] = raw[layout->src[i]];
+    }
+}
+
 int subucom_read(subucom_t* subucom) {
+    return subucom_read_timeout(subucom, SUBUCOM_POLL_TIMEOUT_MS);
+}
+
+/*
+ * Like subucom_read(), but in POLLED mode waits at most timeout_ms for the
+ * next frame. Returns 0 if none arrived in time.
+ */
+int subucom_read_timeout(subucom_t* subucom, int timeout_ms) {
     static bool first_access = true;
     ssize_t bytes_read = 0;
     uint8_t* buf = subucom->_buf;
+    uint8_t* rx = subucom->_rx_buf;
     int ret;
 
     if (subucom->_read_mode == POLLED) {
-        int ret = poll(subucom->fds, 1, 5000); 
-
-        if (ret > 0 && subucom->fds[0].revents & POLLIN) {
-            bytes_read = read(subucom->fd, buf, SUBUCOM_BUFSIZE);
+        int ret = poll(subucom->fds, subucom->nfds, timeout_ms);
+        int64_t t_us = monotonic_micros();
+        TRACE1(poll_wake, "nready=%d", ret);
 
-            if (bytes_read != SUBUCOM_BUFSIZE) {
-                perror("Error reading from device");
-                close(subucom->fd);
-                return -1;
+        for (nfds_t i = 1; ret > 0 && i < subucom->nfds; i++) {
+            if (subucom->fds[i].revents != 0 && subucom->_watches[i].fn != NULL) {
+                subucom->_watches[i].fn(subucom->fds[i].fd, subucom->fds[i].revents, subucom->_watches[i].ctx);
             }
         }
+
+        if (ret <= 0 || !(subucom->fds[0].revents & POLLIN)) {
+            /* no new frame */
+            subucom->frame_changed = false;
+            return 0;
+        }
+
+        /*
+         * LED changes since the last tick go out in the same message as this
+         * tick's read; without SUBUCOM_IOC_MESSAGE they are flushed after it.
+         */
+        uint8_t leds[SUBUCOM_BUFSIZE];
+        subucom_xfer_t xfers[2] = {
+            { .tx = NULL, .rx = rx },
+            { .tx = leds, .rx = NULL },
+        };
+        int n = 1;
+        bool leds_changed = (memcmp(subucom->_leds, subucom->_leds_sent, LED_FRAME_SIZE) != 0);
+        if (leds_changed && subucom->_has_ioc_message) {
+            make_frame(leds, subucom->_leds, LED_FRAME_SIZE);
+            n = 2;
+        }
+
+        int done = subucom_transfer(subucom, xfers, n);
+        if (done < 1) {
+            perror("Error reading from device");
+            close(subucom->fd);
+            return -1;
+        }
+        if (n == 2 && done == 2) {
+            memcpy(subucom->_leds_sent, subucom->_leds, LED_FRAME_SIZE);
+        } else if (leds_changed && !subucom->_has_ioc_message) {
+            subucom_flush_leds(subucom);
+        }
+        bytes_read = SUBUCOM_BUFSIZE;
+        subucom->t_us = t_us;
     } else {
-        bytes_read = read(subucom->fd, buf, SUBUCOM_BUFSIZE);
+        /* the read blocks until the frame is there */
+        bytes_read = read(subucom->fd, rx, SUBUCOM_BUFSIZE);
+        subucom->t_us = monotonic_micros();
 
         if (bytes_read != SUBUCOM_BUFSIZE) {
             perror("Error reading from device");
@@ -300,6 +763,32 @@ int subucom_read(subucom_t* subucom) {
         }
     }
 
+    // validate checksum, a corrupt frame never reaches _buf or _prev_buf
+    TRACE2(read_done, "bytes=%d t_us=%lld", (int)bytes_read, (long long)subucom->t_us);
+
+    ret = validate_checksum(rx);
+    TRACE1(crc, "ok=%d", ret == 0);
+    if (ret < 0) {
+        fprintf(stderr, "subucom_read: Checksum failed\n");
+        subucom->frame_changed = false;
+        return SUBUCOM_ERR_CRC;
+    }
+    memcpy(buf, rx, SUBUCOM_BUFSIZE);
+
+    if (subucom->_layout == NULL) {
+        select_layout(subucom, buf);
+    }
+    if (subucom->_layout->src != NULL) {
+        relayout(subucom->_layout, buf);
+    }
+    if (subucom->_debounce.enabled) {
+        debounce_frame(&subucom->_debounce, buf);
+    }
+    /* _buf is published as is, a rewritten frame must still check out */
+    if (subucom->_layout->src != NULL || subucom->_debounce.enabled) {
+        set_checksum(buf);
+    }
+
     // first read, copy to previous buffer
     if (first_access == true) {
         memcpy(subucom->_prev_buf, buf, SUBUCOM_BUFSIZE);
@@ -314,59 +803,183 @@ int subucom_read(subucom_t* subucom) {
     PRINT("\n");
     #endif
 
+    subucom->frame_changed = (memcmp(buf, subucom->_prev_buf, SUBUCOM_BUFSIZE) != 0);
+    subucom->seq++;
+
+    int num_edges = subucom->frame_changed ? read_history(subucom, buf, subucom->_prev_buf) : 0;
+    if (subucom->frame_changed && subucom->_wear != NULL) {
+        wear_count(subucom->_wear, buf, subucom->_prev_buf);
+    }
+
     // emit input events (if keymap is supplied)
     if (subucom->_keymap != NULL) {
+        if (subucom->_keymap->num_layer_switches > 0) {
+            read_layer_switches(subucom, buf, subucom->_prev_buf);
+        }
         read_buttons(subucom, buf, subucom->_prev_buf);
         read_jog(subucom, buf, subucom->_prev_buf);
         read_encoders(subucom, buf, subucom->_prev_buf);
         read_selectors(subucom, buf, subucom->_prev_buf);
+        if (subucom->_keymap->combos != NULL) {
+            read_combos(subucom, buf);
+        }
+        if (subucom->_keymap->gestures != NULL) {
+            read_gestures(subucom, buf, num_edges);
+        }
+        if (subucom->_keymap->num_feedback > 0) {
+            read_feedback(subucom, buf);
+        }
+    }
+
+    if (subucom->frame_changed && subucom->_state_interest != 0) {
+        read_state_watches(subucom, buf, subucom->_prev_buf);
     }
 
     memcpy(subucom->_prev_buf, buf, SUBUCOM_BUFSIZE);
 
-    // validate checksum
-    ret = validate_checksum(buf);
+    return bytes_read;
+}
+
+/*
+ * The driver doesn't take a plain write() while its timer runs, so in POLLED
+ * mode the timer is paused around it. SUBUCOM_IOC_MESSAGE batches are
+ * ordered with the timer's reads by the driver and need no pause.
+ */
+static ssize_t write_raw(subucom_t* subucom, const uint8_t* frame) {
+    int val = 0;
+    if (subucom->_read_mode == POLLED) {
+        ioctl(subucom->fd, SUBUCOM_IOC_WR_TIMER_STATUS, &val);
+    }
+
+    ssize_t ret = write(subucom->fd, frame, SUBUCOM_BUFSIZE);
+    int err = errno;
+
+    if (subucom->_read_mode == POLLED) {
+        val = 1;
+        ioctl(subucom->fd, SUBUCOM_IOC_WR_TIMER_STATUS, &val);
+    }
+
+    errno = err;
+    return ret;
+}
+
+static int write_frame(subucom_t* subucom, const uint8_t* buf, const uint8_t len) {
+    if (len > SUBUCOM_BUFSIZE-2) {
+        return -1;
+    }
+
+    uint8_t buffer[SUBUCOM_BUFSIZE];
+    make_frame(buffer, buf, len);
+
+    ssize_t ret = write_raw(subucom, buffer);
+
     if (ret < 0) {
-        fprintf(stderr, "subucom_read: Checksum failed\n");
+        fprintf(stderr, "subucom_write: Error writing: %d %s\n", errno, strerror(errno));
         return -1;
     }
 
-    return bytes_read;
+    return 0;
 }
 
 int subucom_write(subucom_t* subucom, const uint8_t* buf, const uint8_t len) {
-    if (subucom->_read_mode == POLLED) {
-        fprintf(stderr, "subucom_write: Unavailable in POLLED mode\n");
+    return write_frame(subucom, buf, len);
+}
+
+/* write a complete frame, CRC already in place (e.g. precomputed animations) */
+int subucom_write_frame(subucom_t* subucom, const uint8_t* frame) {
+    if (write_raw(subucom, frame) < 0) {
+        fprintf(stderr, "subucom_write_frame: Error writing: %d %s\n", errno, strerror(errno));
         return -1;
     }
 
-    if (len > SUBUCOM_BUFSIZE-2) {
+    return 0;
+}
+
+/*
+ * Submit several frames in one go, e.g. a read and an LED write. With
+ * SUBUCOM_IOC_MESSAGE this is one syscall, otherwise the frames are written
+ * and read one after another, the writes under the same rule as any other
+ * (see write_raw()). Returns the number of transfers completed.
+ */
+int subucom_transfer(subucom_t* subucom, const subucom_xfer_t* xfers, int n) {
+    if (n <= 0 || n > SUBUCOM_MAX_XFERS) {
         return -1;
     }
 
-    char buffer[SUBUCOM_BUFSIZE];
-    memcpy(buffer, buf, len);
-    memset(buffer+len, 0x0, SUBUCOM_BUFSIZE-len);
+    if (subucom->_has_ioc_message) {
+        struct subucom_ioc_transfer ioc[SUBUCOM_MAX_XFERS];
+        memset(ioc, 0, sizeof(ioc));
+        for (int i = 0; i < n; i++) {
+            ioc[i].tx_buf = (uintptr_t)xfers[i].tx;
+            ioc[i].rx_buf = (uintptr_t)xfers[i].rx;
+            ioc[i].len = SUBUCOM_BUFSIZE;
+        }
 
-    uint16_t crc16 = crc16_x25_calc(buffer, SUBUCOM_BUFSIZE-2);
-    uint8_t crch = (crc16 & 0xFF);
-    uint8_t crcl = (crc16 >> 8);
+        if (ioctl(subucom->fd, SUBUCOM_IOC_MESSAGE(n), ioc) < 0) {
+            fprintf(stderr, "subucom_transfer: Error: %d %s\n", errno, strerror(errno));
+            return -1;
+        }
+        return n;
+    }
 
-    buffer[SUBUCOM_BUFSIZE-2] = crch;
-    buffer[SUBUCOM_BUFSIZE-1] = crcl;
+    for (int i = 0; i < n; i++) {
+        if (xfers[i].tx != NULL && write_raw(subucom, xfers[i].tx) != SUBUCOM_BUFSIZE) {
+            fprintf(stderr, "subucom_transfer: Error writing: %d %s\n", errno, strerror(errno));
+            return i;
+        }
+        if (xfers[i].rx != NULL && read(subucom->fd, xfers[i].rx, SUBUCOM_BUFSIZE) != SUBUCOM_BUFSIZE) {
+            return i;
+        }
+    }
 
-    int ret = write(subucom->fd, buffer, SUBUCOM_BUFSIZE);
+    return n;
+}
 
-    if (ret < 0) {
-        fprintf(stderr, "subucom_write: Error writing: %d %s\n", errno, strerror(errno));
+/*
+ * LED changes only touch the pending LED frame. In POLLED mode it is written
+ * once per tick, along with the tick's read, and only if it differs from the
+ * last frame written, so any number of changes cost one transfer.
+ */
+void subucom_set_led(subucom_t* subucom, led_id_t led, uint8_t level) {
+    led_set_level(subucom->_leds, led, level);
+}
+
+void subucom_set_leds(subucom_t* subucom, const uint8_t* frame) {
+    memcpy(subucom->_leds, frame, LED_FRAME_SIZE);
+}
+
+/* write the pending LED frame if it changed, subucom_read() does this itself in POLLED mode */
+int subucom_flush_leds(subucom_t* subucom) {
+    if (memcmp(subucom->_leds, subucom->_leds_sent, LED_FRAME_SIZE) == 0) {
+        return 0;
+    }
+
+    if (write_frame(subucom, subucom->_leds, LED_FRAME_SIZE) != 0) {
         return -1;
     }
 
-    return 0;
+    memcpy(subucom->_leds_sent, subucom->_leds, LED_FRAME_SIZE);
+    return 1;
+}
+
+/* apply an EV_LED event through the [leds] bindings of the keymap */
+void subucom_set_evdev_led(subucom_t* subucom, int code, int val) {
+    if (subucom->_keymap == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < subucom->_keymap->num_led_bindings; i++) {
+        const led_binding_t* binding = &subucom->_keymap->led_bindings[i];
+        if (binding->code == code) {
+            uint8_t level = (val != 0) ? (uint8_t)((1u << led_defs[binding->led].width) - 1) : 0;
+            subucom_set_led(subucom, binding->led, level);
+        }
+    }
 }
 
 void subucom_deinit(const subucom_t* subucom) {
     close(subucom->fd);
     free(subucom->_buf);
+    free(subucom->_rx_buf);
     free(subucom->_prev_buf);
 }
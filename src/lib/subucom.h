@@ -15,9 +15,23 @@
 #include <stdint.h>
 #include <sys/ioctl.h>
 
+#include "debounce.h"
 #include "keymap.h"
+#include "layout.h"
+#include "leds.h"
+#include "protocol.h"
+#include "state.h"
+#include "wear.h"
 
 #define SUBUCOM_BUFSIZE      64
+#define SUBUCOM_MAX_POLL_FDS 16
+#define SUBUCOM_POLL_TIMEOUT_MS 5000
+
+#define SUBUCOM_MAX_XFERS    4
+#define SUBUCOM_MAX_STATE_WATCHES 8
+
+/* subucom_read() result for a frame that failed its CRC check */
+#define SUBUCOM_ERR_CRC      (-2)
 
 #ifdef DEBUG_SUBUCOM
 #define PRINT(...) printf( __VA_ARGS__ )
@@ -30,17 +44,63 @@ enum read_mode {
 	POLLED
 };
 
-typedef void (*input_event_cb_t)(int type, int code, int val);
+/* t_us is the CLOCK_MONOTONIC arrival time of the frame causing the event */
+typedef void (*input_event_cb_t)(int type, int code, int val, int64_t t_us);
+typedef void (*poll_fd_cb_t)(int fd, short revents, void* ctx);
+
+typedef struct subucom_watch {
+    poll_fd_cb_t     fn;
+    void*            ctx;
+} subucom_watch_t;
+
+struct subucom;
+
+/* changed holds the SUBUCOM_STATE_* groups of interest that changed */
+typedef void (*state_cb_t)(struct subucom* subucom, uint32_t changed, void* ctx);
+
+typedef struct subucom_state_watch {
+    uint32_t         fields;
+    state_cb_t       fn;
+    void*            ctx;
+} subucom_state_watch_t;
+
+/* one frame of a batched transfer, see subucom_transfer() */
+typedef struct subucom_xfer {
+    const uint8_t*   tx;    /* SUBUCOM_BUFSIZE bytes to write, CRC included, or NULL */
+    uint8_t*         rx;    /* SUBUCOM_BUFSIZE bytes to read into, or NULL */
+} subucom_xfer_t;
 
 typedef struct subucom {
 	int			 	 fd;
-    struct pollfd    fds[1];
+    struct pollfd    fds[SUBUCOM_MAX_POLL_FDS];  /* fds[0] is the subucom device */
+    nfds_t           nfds;
     input_event_cb_t fire_input_event_fn;
+    bool             frame_changed;     /* last frame differs from the one before */
+    uint32_t         seq;               /* number of valid frames read */
+    int64_t          t_us;              /* CLOCK_MONOTONIC time the last frame arrived */
+    uint8_t          major_revision;    /* firmware revision, from the first valid frame */
+    uint8_t          minor_revision;
 
 	enum read_mode   _read_mode;
-	uint8_t*         _buf;
+    bool             _has_ioc_message;  /* driver takes SUBUCOM_IOC_MESSAGE */
+    const subucom_layout_t* _layout;    /* NULL until the first valid frame */
+	uint8_t*         _buf;              /* last valid frame */
+    uint8_t*         _rx_buf;           /* last frame received, valid or not */
     uint8_t*         _prev_buf;
     keymap_t*        _keymap;
+    keymap_t*        _layer;            /* active layer of _keymap */
+    uint8_t          _layer_index;
+    subucom_watch_t  _watches[SUBUCOM_MAX_POLL_FDS];
+    uint8_t          _leds[LED_FRAME_SIZE];      /* pending LED frame */
+    uint8_t          _leds_sent[LED_FRAME_SIZE]; /* last LED frame written */
+    uint8_t          _feedback_out[KEYMAP_MAX_FEEDBACK]; /* level set by each feedback */
+    subucom_state_t  _state;            /* decoded lazily from _buf */
+    subucom_state_watch_t _state_watches[SUBUCOM_MAX_STATE_WATCHES];
+    uint8_t          _num_state_watches;
+    uint32_t         _state_interest;   /* union of the watched fields */
+    gesture_history_t _history;         /* recent button and rotary edges */
+    debounce_t       _debounce;         /* applied before decoding when enabled */
+    wear_counters_t* _wear;             /* counted into when set */
 } subucom_t;
 
 /* Read / Write timer status */
@@ -52,22 +112,50 @@ typedef struct subucom {
 #define SUBUCOM_IOC_RD_TIMER_INTERVAL	_IOR(SUBUCOM_IOC_MAGIC, 2, __u32)
 #define SUBUCOM_IOC_WR_TIMER_INTERVAL	_IOW(SUBUCOM_IOC_MAGIC, 2, __u32)
 
-// #define SUBUCOM_MSGSIZE(N) \
-// 	((((N)*(sizeof (struct subucom_ioc_transfer))) < (1 << _IOC_SIZEBITS)) \
-// 	? ((N)*(sizeof (struct subucom_ioc_transfer))) : 0)
+/* one frame of a message, laid out like spidev's struct spi_ioc_transfer */
+struct subucom_ioc_transfer {
+	__u64		tx_buf;
+	__u64		rx_buf;
+	__u32		len;
+	__u32		pad;
+};
 
-// /* Transmit Tx message */
-// #define SUBUCOM_IOC_MESSAGE(N)	_IOW(SUBUCOM_IOC_MAGIC, 0, char[SUBUCOM_MSGSIZE(N)])
+#define SUBUCOM_MSGSIZE(N) \
+	((((N)*(sizeof (struct subucom_ioc_transfer))) < (1 << _IOC_SIZEBITS)) \
+	? ((N)*(sizeof (struct subucom_ioc_transfer))) : 0)
+
+/* Transmit Tx message */
+#define SUBUCOM_IOC_MESSAGE(N)	_IOW(SUBUCOM_IOC_MAGIC, 0, char[SUBUCOM_MSGSIZE(N)])
 
 #define SUBUCOM_IOC_TEST	_IOW(SUBUCOM_IOC_MAGIC, 0, __u8)
 
 int  subucom_init(subucom_t* subucom, const char *device_path);
+int  subucom_init_fd(subucom_t* subucom, int fd);
 int  subucom_register_keymap(subucom_t* subucom, keymap_t* keymap, input_event_cb_t fire_input_event_cb);
+void subucom_swap_keymap(subucom_t* subucom, keymap_t* keymap);
+int  subucom_watch_fd(subucom_t* subucom, int fd, short events, poll_fd_cb_t cb, void* ctx);
+void subucom_unwatch_fd(subucom_t* subucom, int fd);
+int  subucom_watch_state(subucom_t* subucom, uint32_t fields, state_cb_t cb, void* ctx);
+int  subucom_set_debounce(subucom_t* subucom, const uint8_t frames[DEBOUNCE_NUM_CLASSES]);
+void subucom_count_wear(subucom_t* subucom, wear_counters_t* wear);
 void subucom_deinit(const subucom_t* subucom);
 
+/* decoded state of the last frame */
+const subucom_state_t* subucom_get_state(subucom_t* subucom, uint32_t fields);
+const gesture_edge_t*  subucom_history(const subucom_t* subucom, uint32_t age);
+
 /* low level functions */
 int  subucom_read(subucom_t* subucom);
+int  subucom_read_timeout(subucom_t* subucom, int timeout_ms);
 int  subucom_write(subucom_t* subucom, const uint8_t* buf, const uint8_t len);
+int  subucom_write_frame(subucom_t* subucom, const uint8_t* frame);
+int  subucom_transfer(subucom_t* subucom, const subucom_xfer_t* xfers, int n);
+
+/* coalesced LED output */
+void subucom_set_led(subucom_t* subucom, led_id_t led, uint8_t level);
+void subucom_set_leds(subucom_t* subucom, const uint8_t* frame);
+int  subucom_flush_leds(subucom_t* subucom);
+void subucom_set_evdev_led(subucom_t* subucom, int code, int val);
 
 void subucom_start_timer(subucom_t* subucom, int tick_ms);
 void subucom_stop_timer(subucom_t* subucom);
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom static tracepoints
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+static const char* trace_marker_paths[] = {
+    "/sys/kernel/tracing/trace_marker",
+    "/sys/kernel/debug/tracing/trace_marker",
+};
+
+/* trace_marker, -1 while mirroring is off */
+int subucom_trace_fd = -1;
+
+/* mirror the probes to the ftrace trace_marker */
+int subucom_trace_open(void) {
+    for (size_t i = 0; i < sizeof(trace_marker_paths) / sizeof(trace_marker_paths[0]); i++) {
+        int fd = open(trace_marker_paths[i], O_WRONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            subucom_trace_fd = fd;
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "subucom_trace: Error opening trace_marker: %s\n", strerror(errno));
+    return -1;
+}
+
+void subucom_trace_marker(const char* fmt, ...) {
+    char buf[128];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    if (len > (int)sizeof(buf) - 1) {
+        len = sizeof(buf) - 1;
+    }
+    /* one write is one marker entry */
+    write(subucom_trace_fd, buf, len);
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom static tracepoints
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __TRACE_H_
+#define __TRACE_H_
+
+/*
+ * Probes along the read -> decode -> emit path, under the "subucom" provider:
+ *
+ *   poll_wake     nready                   poll() returned
+ *   read_done     bytes, t_us              frame read from the device
+ *   crc           ok                       CRC check of the frame
+ *   decode        type, code, val          input event decoded from the frame
+ *   uinput_flush  type, code, t_us         event report written to uinput
+ *
+ * With <sys/sdt.h> at build time they are USDT notes, a single nop each until
+ * a tracer attaches (perf probe sdt_subucom:*, bpftrace usdt:...). After
+ * subucom_trace_open() they are also written to the ftrace trace_marker, so
+ * trace-cmd shows them next to the kernel SPI and input events.
+ */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#else
+#define STAP_PROBE1(provider, name, a)          do { } while (0)
+#define STAP_PROBE2(provider, name, a, b)       do { } while (0)
+#define STAP_PROBE3(provider, name, a, b, c)    do { } while (0)
+#endif
+
+extern int subucom_trace_fd;
+
+int  subucom_trace_open(void);
+void subucom_trace_marker(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#define TRACE_MARKER(name, fmt, ...) \
+    do { \
+        if (__builtin_expect(subucom_trace_fd >= 0, 0)) { \
+            subucom_trace_marker("subucom_" #name ": " fmt "\n", __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define TRACE1(name, fmt, a) \
+    do { STAP_PROBE1(subucom, name, a); TRACE_MARKER(name, fmt, a); } while (0)
+#define TRACE2(name, fmt, a, b) \
+    do { STAP_PROBE2(subucom, name, a, b); TRACE_MARKER(name, fmt, a, b); } while (0)
+#define TRACE3(name, fmt, a, b, c) \
+    do { STAP_PROBE3(subucom, name, a, b, c); TRACE_MARKER(name, fmt, a, b, c); } while (0)
+
+#endif /* __TRACE_H_ */
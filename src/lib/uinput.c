@@ -11,67 +11,162 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
-#include <sys/time.h>
+#include <dirent.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/inotify.h>
 
 #include <linux/input.h>
 #include <linux/uinput.h>
 
 #include "uinput.h"
 #include "keymap.h"
+#include "trace.h"
 
 #define REPEAT_MS      30
+#define READY_TIMEOUT_MS  1000
 
 const char *uinput_device_path = "/dev/uinput";
 
-static int64_t current_time_millis() {
-  struct timeval time;
-  gettimeofday(&time, NULL);
-  int64_t s1 = (int64_t)(time.tv_sec) * 1000;
-  int64_t s2 = time.tv_usec / 1000;
-  return s1 + s2;
+static int64_t monotonic_millis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-static void emit(int fd, int type, int code, int val)
-{
-   struct input_event ie;
+/* find the evdev node the kernel attached to our uinput device */
+static int find_devnode(uinput_t* uinput) {
+   char sysname[32];
+   char path[128];
+
+   if (ioctl(uinput->fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) {
+      return -1;
+   }
+
+   snprintf(path, sizeof(path), "/sys/devices/virtual/input/%s", sysname);
+   DIR* dir = opendir(path);
+   if (dir == NULL) {
+      return -1;
+   }
+
+   int ret = -1;
+   struct dirent* entry;
+   while ((entry = readdir(dir)) != NULL) {
+      if (strncmp(entry->d_name, "event", 5) == 0) {
+         snprintf(uinput->devnode, sizeof(uinput->devnode), "/dev/input/%.32s", entry->d_name);
+         ret = 0;
+         break;
+      }
+   }
+   closedir(dir);
+
+   return ret;
+}
+
+/*
+ * Wait until the device node for the new device shows up in /dev/input,
+ * so that userspace listening there can open it before the first event.
+ */
+static int wait_for_devnode(uinput_t* uinput, int timeout_ms) {
+   if (find_devnode(uinput) != 0) {
+      return -1;
+   }
+
+   int ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   if (ifd < 0) {
+      return -1;
+   }
+   inotify_add_watch(ifd, "/dev/input", IN_CREATE | IN_ATTRIB | IN_MOVED_TO);
+
+   int64_t deadline = monotonic_millis() + timeout_ms;
+   int ret = -1;
+
+   while (1) {
+      if (access(uinput->devnode, R_OK) == 0) {
+         ret = 0;
+         break;
+      }
+
+      int64_t remaining = deadline - monotonic_millis();
+      if (remaining <= 0) {
+         break;
+      }
+
+      struct pollfd pfd = { .fd = ifd, .events = POLLIN };
+      if (poll(&pfd, 1, (int)remaining) > 0) {
+         char buf[1024];
+         while (read(ifd, buf, sizeof(buf)) > 0) { }
+      }
+   }
 
-   ie.type = type;
-   ie.code = code;
-   ie.value = val;
-   ie.time.tv_sec = 0;
-   ie.time.tv_usec = 0;
+   close(ifd);
+   return ret;
+}
 
-   write(fd, &ie, sizeof(ie));
+static void fill(struct input_event* ie, int type, int code, int val, int64_t t_us)
+{
+   ie->type = type;
+   ie->code = code;
+   ie->value = val;
+   ie->time.tv_sec = t_us / 1000000;
+   ie->time.tv_usec = t_us % 1000000;
 }
 
-void uinput_emit(uinput_t* uinput, int type, int code, int val)
+/*
+ * t_us is the CLOCK_MONOTONIC time the frame arrived. uinput replaces the
+ * event time with its own, so every report also carries it as MSC_TIMESTAMP
+ * (microseconds, wrapping at 32 bits) for latency compensation.
+ *
+ * The report goes out in one write, so it is either taken whole or not at
+ * all. Returns 0 once written or filtered, -1 with errno set otherwise
+ * (EAGAIN if the device can't take it right now).
+ */
+int uinput_emit(uinput_t* uinput, int type, int code, int val, int64_t t_us)
 {
    /* ignore reserved code */
    if (type == EV_KEY && code == 0) {
-      return;
+      return 0;
    }
 
    /* rate limit repeats */
-   static int64_t last_tv_msec = 0;
-   int64_t tv_msec = current_time_millis();
+   static int64_t last_repeat_ms = 0;
+   int64_t t_ms = t_us / 1000;
    if (val == 2) {
-      if (tv_msec < last_tv_msec + REPEAT_MS) {
-         return;
+      if (t_ms < last_repeat_ms + REPEAT_MS) {
+         return 0;
       }
-      last_tv_msec = tv_msec;
+      last_repeat_ms = t_ms;
    }
 
    // printf("uinput: emitting: fd=%d, type=%02x, code=%d, val=%d\n", uinput->fd, type, code, val);
 
-   emit(uinput->fd, type, code, val);
-   emit(uinput->fd, EV_SYN, SYN_REPORT, 0);
+   struct input_event report[3];
+   fill(&report[0], EV_MSC, MSC_TIMESTAMP, (int)(uint32_t)t_us, t_us);
+   fill(&report[1], type, code, val, t_us);
+   fill(&report[2], EV_SYN, SYN_REPORT, 0, t_us);
+
+   if (write(uinput->fd, report, sizeof(report)) != sizeof(report)) {
+      return -1;
+   }
+   TRACE3(uinput_flush, "type=%d code=%d t_us=%lld", type, code, (long long)t_us);
+   return 0;
+}
+
+/*
+ * Read the next event written to our device by applications, e.g. EV_LED.
+ * Returns 1 for an event and 0 once none are pending.
+ */
+int uinput_read(uinput_t* uinput, struct input_event* ev)
+{
+   return (read(uinput->fd, ev, sizeof(*ev)) == sizeof(*ev)) ? 1 : 0;
 }
 
 int uinput_init(uinput_t* uinput, keymap_t* keymap)
 {
    struct uinput_setup usetup;
 
-   int fd = open(uinput_device_path, O_WRONLY | O_NONBLOCK);
+   /* read back as well, for the events applications write to the device */
+   int fd = open(uinput_device_path, O_RDWR | O_NONBLOCK);
    if (fd < 0) {
       fprintf(stderr, "Error opening device %s: %s\n", uinput_device_path, strerror(errno));
       return -1;
@@ -80,8 +175,24 @@ int uinput_init(uinput_t* uinput, keymap_t* keymap)
    uinput->fd = fd;
 
    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+   ioctl(fd, UI_SET_EVBIT, EV_MSC);
+   ioctl(fd, UI_SET_MSCBIT, MSC_TIMESTAMP);
    keymap_register_uinput_keycodes(keymap, fd);
 
+   /*
+    * Key bits can't be changed once the device exists, so a keymap that may
+    * be reloaded at runtime needs every regular key registered up front.
+    */
+   if (uinput->all_keys) {
+      for (int code = KEY_ESC; code <= KEYMAP_MAX_KEYCODE; code++) {
+         ioctl(fd, UI_SET_KEYBIT, code);
+      }
+      ioctl(fd, UI_SET_EVBIT, EV_LED);
+      for (int code = 0; code <= LED_MAX; code++) {
+         ioctl(fd, UI_SET_LEDBIT, code);
+      }
+   }
+
    memset(&usetup, 0, sizeof(usetup));
    usetup.id.bustype = BUS_SPI;
    usetup.id.vendor = 0x1234; /* sample vendor */
@@ -89,27 +200,36 @@ int uinput_init(uinput_t* uinput, keymap_t* keymap)
    strcpy(usetup.name, "Subucom Input Device");
 
    ioctl(fd, UI_DEV_SETUP, &usetup);
-   ioctl(fd, UI_DEV_CREATE);
+   if (ioctl(fd, UI_DEV_CREATE) < 0) {
+      fprintf(stderr, "Error creating uinput device: %s\n", strerror(errno));
+      close(fd);
+      return -1;
+   }
 
    /*
     * On UI_DEV_CREATE the kernel will create the device node for this
-    * device. We are inserting a pause here so that userspace has time
-    * to detect, initialize the new device, and can start listening to
-    * the event, otherwise it will not notice the event we are about
-    * to send.
+    * device. Wait for it to appear so that userspace can detect the new
+    * device before the first event is sent. Kernels without UI_GET_SYSNAME
+    * get the old fixed pause.
     */
-   sleep(1);
+   uinput->devnode[0] = '\0';
+   if (wait_for_devnode(uinput, READY_TIMEOUT_MS) != 0) {
+      if (uinput->devnode[0] == '\0') {
+         sleep(1);
+      } else {
+         fprintf(stderr, "uinput: %s did not show up in time\n", uinput->devnode);
+      }
+   }
 
    return 0;
 }
 
 void uinput_deinit(uinput_t* uinput) {
    /*
-    * Give userspace some time to read the events before we destroy the
-    * device with UI_DEV_DESTOY.
+    * No pause before UI_DEV_DESTROY: readers drop all state of a device
+    * when it goes away, so the only events that matter are key releases,
+    * and callers send those before tearing down.
     */
-   sleep(1);
-
    ioctl(uinput->fd, UI_DEV_DESTROY);
    close(uinput->fd); 
 }
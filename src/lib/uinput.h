@@ -9,13 +9,21 @@
 #ifndef __SUBUCOM_UINPUT_H_
 #define __SUBUCOM_UINPUT_H_
 
+#include <stdbool.h>
+#include <linux/input.h>
+
 #include "keymap.h"
 
+#define UINPUT_DEVNODE_MAX	64
+
 typedef struct uinput {
 	int				fd;
+	bool			all_keys;	/* set before uinput_init() to allow any keymap reload */
+	char			devnode[UINPUT_DEVNODE_MAX];	/* e.g. /dev/input/event3, once ready */
 } uinput_t;
 
-void uinput_emit(uinput_t* uinput, int type, int code, int val);
+int  uinput_emit(uinput_t* uinput, int type, int code, int val, int64_t t_us);
+int  uinput_read(uinput_t* uinput, struct input_event* ev);
 int  uinput_init(uinput_t* uinput, keymap_t* keymap);
 void uinput_deinit(uinput_t* uinput);
 
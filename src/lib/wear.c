@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom wear counters
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "wear.h"
+
+static uint16_t be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+/*
+ * Count the actuations between two validated frames. Called from the read
+ * path for every changed frame: plain increments, no locks or syscalls.
+ */
+void wear_count(wear_counters_t* wear, const uint8_t* frame, const uint8_t* prev_frame) {
+    for (int i = 0; i < WEAR_NUM_BUTTONS / 8; i++) {
+        uint8_t pressed = frame[SUBUCOM_IN_PLAY_BYTE + i] & ~prev_frame[SUBUCOM_IN_PLAY_BYTE + i];
+        while (pressed != 0) {
+            int bit = __builtin_ctz(pressed);
+            wear->presses[i * 8 + bit]++;
+            pressed &= pressed - 1;
+        }
+    }
+
+    const uint8_t JOG = SUBUCOM_IN_JOG_PRESS_BYTE;
+    if (frame[JOG] & ~prev_frame[JOG] & SUBUCOM_IN_JOG_PRESS_MASK) {
+        wear->jog_presses++;
+    }
+
+    const uint8_t SLIP = SUBUCOM_IN_SLIP_PADDLE_BYTE;
+    if ((frame[SLIP] ^ prev_frame[SLIP]) & SUBUCOM_IN_SLIP_PADDLE_MASK) {
+        wear->slip_paddle_moves++;
+    }
+
+    /* positions wrap, the short way round is the one taken */
+    int16_t jog = be16(frame + SUBUCOM_IN_JOG_POS_BYTE) - be16(prev_frame + SUBUCOM_IN_JOG_POS_BYTE);
+    wear->jog_ticks += (jog < 0) ? -jog : jog;
+
+    int16_t rotary = be16(frame + SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE) - be16(prev_frame + SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE);
+    wear->rotary_detents += (rotary < 0) ? -rotary : rotary;
+}
+
+/* a missing file starts all counters from zero */
+int wear_load(wear_counters_t* wear, const char* path) {
+    memset(wear, 0, sizeof(wear_counters_t));
+    wear->magic = WEAR_MAGIC;
+    wear->version = WEAR_VERSION;
+    wear->since = time(NULL);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        fprintf(stderr, "wear: Error opening %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    wear_counters_t saved;
+    ssize_t n = read(fd, &saved, sizeof(saved));
+    close(fd);
+
+    if (n != sizeof(saved) || saved.magic != WEAR_MAGIC || saved.version != WEAR_VERSION) {
+        fprintf(stderr, "wear: %s is not a wear counter file\n", path);
+        return -1;
+    }
+
+    *wear = saved;
+    return 0;
+}
+
+/* replace path as a whole, readers see either the old or the new counters */
+int wear_save(wear_counters_t* wear, const char* path) {
+    char tmp_path[256];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "wear: Path too long: %s\n", path);
+        return -1;
+    }
+
+    wear->saved = time(NULL);
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "wear: Error creating %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    if (write(fd, wear, sizeof(wear_counters_t)) != sizeof(wear_counters_t) || fsync(fd) != 0) {
+        fprintf(stderr, "wear: Error writing %s: %s\n", tmp_path, strerror(errno));
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+    close(fd);
+
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "wear: Error replacing %s: %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Save a snapshot of the counters from a forked child, so the caller's read
+ * loop never waits on the disk. Returns the child's pid, to be reaped with
+ * waitpid(), or -1 if it could not be started.
+ */
+pid_t wear_save_background(const wear_counters_t* wear, const char* path) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "wear: Error forking: %s\n", strerror(errno));
+        return -1;
+    }
+    if (pid == 0) {
+        wear_counters_t snapshot = *wear;
+        _exit(wear_save(&snapshot, path) == 0 ? 0 : 1);
+    }
+    return pid;
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom wear counters
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#ifndef __WEAR_H_
+#define __WEAR_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "protocol.h"
+
+#define WEAR_DIR                "/var/lib/subucom"
+#define WEAR_FILE               "wear"
+#define WEAR_MAGIC              0x57425553  /* "SUBW" */
+#define WEAR_VERSION            1
+#define WEAR_FLUSH_INTERVAL_S   300
+
+#define WEAR_NUM_BUTTONS        64          /* bytes 5-12, bit (byte - 5) * 8 + bit */
+
+/*
+ * Lifetime actuation counts, kept in memory by the process reading the
+ * device and replaced on disk as a whole every WEAR_FLUSH_INTERVAL_S.
+ * The file is this struct as is, in host byte order.
+ */
+typedef struct wear_counters {
+    uint32_t magic;
+    uint32_t version;
+    int64_t  since;                         /* wall clock time counting started */
+    int64_t  saved;                         /* wall clock time of the last save */
+    uint64_t presses[WEAR_NUM_BUTTONS];
+    uint64_t jog_presses;
+    uint64_t slip_paddle_moves;
+    uint64_t jog_ticks;                     /* JOG_POS counts turned, either way, scale unmeasured */
+    uint64_t rotary_detents;
+} wear_counters_t;
+
+void wear_count(wear_counters_t* wear, const uint8_t* frame, const uint8_t* prev_frame);
+int  wear_load(wear_counters_t* wear, const char* path);
+int  wear_save(wear_counters_t* wear, const char* path);
+pid_t wear_save_background(const wear_counters_t* wear, const char* path);
+
+#endif /* __WEAR_H_ */
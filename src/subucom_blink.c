@@ -13,91 +13,113 @@
 #include <unistd.h>
 
 #include "lib/subucom.h"
+#include "lib/led_anim.h"
+
+#define STEP_MS     20
 
 int loop;
 void trap(int signal){ loop = 0; }
 
-#define SUBUCOM_BUFSIZE_LED SUBUCOM_BUFSIZE-2
-
-uint8_t buf_on[SUBUCOM_BUFSIZE_LED];
-uint8_t buf_off[SUBUCOM_BUFSIZE_LED];
-
-static void setup_buffers() {
-    memset(buf_on, 0x00, SUBUCOM_BUFSIZE_LED);
-    memset(buf_off, 0x00, SUBUCOM_BUFSIZE_LED);
-
-    buf_on[0x02] =  0xFF; // 0x3F;
-    buf_on[0x03] =  0xFF; // 0xFF;
-    buf_on[0x04] =  0xFF; // 0xFF;
-    buf_on[0x05] =  0xFF; // 0xCF;
-    buf_on[0x06] =  0xFF; // 0x00;
-    buf_on[0x07] =  0xFF; // 0xFB;
-    buf_on[0x08] =  0xFF; // 0xDB;
-    buf_on[0x09] =  0xFF; // 0x15;
-    buf_on[0x0a] =  0x10; // 0x10;
-    buf_on[0x0b] =  0xFF; // 0x00;
-    buf_on[0x0c] =  0xFF; // 0x44;
-    buf_on[0x0d] =  0xFF; // 0x78;
-    buf_on[0x0e] =  0xFF; // 0x7F;
-    buf_on[0x0f] =  0xFF; // 0x44;
-    buf_on[0x10] =  0xFF; // 0x78;
-    buf_on[0x11] =  0xFF; // 0x7F;
-    buf_on[0x12] =  0xFF; // 0x44;
-    buf_on[0x13] =  0xFF; // 0x78;
-    buf_on[0x14] =  0xFF; // 0x7F;
-    buf_on[0x15] =  0xFF; // 0x44;
-    buf_on[0x16] =  0xFF; // 0x78;
-    buf_on[0x17] =  0xFF; // 0x7F;
-    buf_on[0x18] =  0xFF; // 0x44;
-    buf_on[0x19] =  0xFF; // 0x78;
-    buf_on[0x1a] =  0xFF; // 0x7F;
-    buf_on[0x1b] =  0xFF; // 0x44;
-    buf_on[0x1c] =  0xFF; // 0x78;
-    buf_on[0x1d] =  0xFF; // 0x7F;
-    buf_on[0x1e] =  0xFF; // 0x44;
-    buf_on[0x1f] =  0xFF; // 0x78;
-    buf_on[0x20] =  0xFF; // 0x7F;
-    buf_on[0x21] =  0xFF; // 0x44;
-    buf_on[0x22] =  0xFF; // 0x78;
-    buf_on[0x23] =  0xFF; // 0x7F;
-    buf_on[0x24] =  0xFF; // 0x88;
-    buf_on[0x25] =  0xFF; // 0xF0;
-    buf_on[0x26] =  0xFF; // 0xFF;
-    buf_on[0x27] =  0xFF; // 0x88;
-    buf_on[0x28] =  0xFF; // 0xF0;
-    buf_on[0x29] =  0xFF; // 0xFF;
-    buf_on[0x2a] =  0xFF; // 0x88;
-    buf_on[0x2b] =  0xFF; // 0xF0;
-    buf_on[0x2c] =  0xFF; // 0xFF;
-
-    buf_on[0x00] =  0xFF; // 0x3F;
-    buf_on[0x01] =  0xFF; // 0xFF;
-    buf_on[0x2d] =  0xFF; // 0xFF;
-    buf_on[0x2e] =  0xFF; // 0xFF;
-    buf_on[0x2f] =  0xFF; // 0xFF;
-    buf_on[0x30] =  0xFF; // 0x78;
-    buf_on[0x31] =  0xFF; // 0x7F;
-    buf_on[0x32] =  0xFF; // 0x44;
-    buf_on[0x33] =  0xFF; // 0x78;
-    buf_on[0x34] =  0xFF; // 0x7F;
-    buf_on[0x35] =  0xFF; // 0x44;
-    buf_on[0x36] =  0xFF; // 0x78;
-    buf_on[0x37] =  0xFF; // 0x7F;
-    buf_on[0x38] =  0xFF; // 0x44;
-    buf_on[0x39] =  0xFF; // 0x78;
-    buf_on[0x3a] =  0xFF; // 0x7F;
-    buf_on[0x3b] =  0xFF; // 0x44;
-    buf_on[0x3c] =  0xFF; // 0x78;
-    buf_on[0x3d] =  0xFF; // 0x7F;
+static const uint8_t hotcues_white[] = {
+    LED_HOTCUE_A_R, LED_HOTCUE_A_G, LED_HOTCUE_A_B,
+    LED_HOTCUE_B_R, LED_HOTCUE_B_G, LED_HOTCUE_B_B,
+    LED_HOTCUE_C_R, LED_HOTCUE_C_G, LED_HOTCUE_C_B,
+    LED_HOTCUE_D_R, LED_HOTCUE_D_G, LED_HOTCUE_D_B,
+    LED_HOTCUE_E_R, LED_HOTCUE_E_G, LED_HOTCUE_E_B,
+    LED_HOTCUE_F_R, LED_HOTCUE_F_G, LED_HOTCUE_F_B,
+    LED_HOTCUE_G_R, LED_HOTCUE_G_G, LED_HOTCUE_G_B,
+    LED_HOTCUE_H_R, LED_HOTCUE_H_G, LED_HOTCUE_H_B,
+};
+
+static const uint8_t media_white[] = {
+    LED_SD_R, LED_SD_G, LED_SD_B,
+    LED_USB_R, LED_USB_G, LED_USB_B,
+    LED_MEDIA_COLOR_R, LED_MEDIA_COLOR_G, LED_MEDIA_COLOR_B,
+};
+
+static const uint8_t transport[] = { LED_PLAY, LED_CUE };
+
+/* every LED, for testing */
+static int setup_blink(led_timeline_t* tl) {
+    uint8_t leds[NUM_LEDS];
+    for (int i = 0; i < NUM_LEDS; i++) {
+        leds[i] = i;
+    }
+
+    led_timeline_init(tl, STEP_MS, 1000, true);
+    return led_timeline_add(tl, LED_BLINK, leds, NUM_LEDS, 1000, 0, LED_ANIM_MAX_LEVEL);
+}
+
+/* standby: slow breathing hot cues and media LEDs */
+static int setup_pulse(led_timeline_t* tl) {
+    led_timeline_init(tl, STEP_MS, 4000, true);
+    if (led_timeline_add(tl, LED_PULSE, hotcues_white, sizeof(hotcues_white), 4000, 0, LED_ANIM_MAX_LEVEL) < 0) {
+        return -1;
+    }
+    return led_timeline_add(tl, LED_PULSE, media_white, sizeof(media_white), 4000, 2000, LED_ANIM_MAX_LEVEL / 2);
+}
+
+/* diagnostics: white light running over the hot cues, PLAY/CUE alternating */
+static int setup_chase(led_timeline_t* tl) {
+    led_timeline_init(tl, STEP_MS, 800, true);
+    int i = led_timeline_add(tl, LED_CHASE, hotcues_white, sizeof(hotcues_white), 800, 0, LED_ANIM_MAX_LEVEL);
+    if (i < 0) {
+        return -1;
+    }
+    tl->anims[i].group = 3;
+
+    i = led_timeline_add(tl, LED_CHASE, transport, sizeof(transport), 800, 0, LED_ANIM_MAX_LEVEL);
+    return i;
+}
+
+/* everything fades in and out again */
+static int setup_fade(led_timeline_t* tl) {
+    led_timeline_init(tl, STEP_MS, 3000, true);
+    if (led_timeline_add(tl, LED_FADE_IN, hotcues_white, sizeof(hotcues_white), 1000, 0, LED_ANIM_MAX_LEVEL) < 0) {
+        return -1;
+    }
+    return led_timeline_add(tl, LED_FADE_OUT, hotcues_white, sizeof(hotcues_white), 3000, 0, LED_ANIM_MAX_LEVEL);
 }
 
 int main(int argc, char *argv[]) {
     subucom_t subucom;
+    led_timeline_t timeline;
     int ret;
 
+    const char *effect = "blink";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:")) != -1) {
+        switch (opt) {
+        case 'e':
+            effect = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-e blink|pulse|chase|fade] [device]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
     char *device_path = NULL;
-    if (argc == 2) {
-        device_path = argv[1];
+    if (optind < argc) {
+        device_path = argv[optind];
+    }
+
+    if (strcmp(effect, "blink") == 0) {
+        ret = setup_blink(&timeline);
+    } else if (strcmp(effect, "pulse") == 0) {
+        ret = setup_pulse(&timeline);
+    } else if (strcmp(effect, "chase") == 0) {
+        ret = setup_chase(&timeline);
+    } else if (strcmp(effect, "fade") == 0) {
+        ret = setup_fade(&timeline);
+    } else {
+        fprintf(stderr, "subucom_blink: Unknown effect %s\n", effect);
+        exit(-1);
+    }
+
+    if (ret < 0 || led_timeline_compile(&timeline) != 0) {
+        exit(-1);
     }
 
     ret = subucom_init(&subucom, device_path);
@@ -105,63 +127,25 @@ int main(int argc, char *argv[]) {
         exit(-1);
     }
 
-    setup_buffers();
-
     signal(SIGINT, &trap);
 
-    loop = 1;
-    
-    int8_t bit_mask = 0x0;
-
-    int8_t buf_idx = 0x02; // 0x0b;
-    int8_t bit_idx = 0;
-
-    uint8_t *buf = buf_off;
-    while (loop) {      
-        uint8_t *buf = (buf_idx % 2 == 0) ? buf_on :  buf_off;
-
-        // // !! byte 10 crashes player
-
-        // uint8_t c = buf[buf_idx];
-
-        // buf[buf_idx] = (1 << bit_idx);
-        // // buf[buf_idx] = c | (1 << bit_idx);
-        // // buf[buf_idx] = c+1;
-        
-
-        // printf("%02x-%02x -- ", buf_idx, bit_idx);
-
-        // // write
-
-        subucom_write(&subucom, buf, SUBUCOM_BUFSIZE_LED);
-        // bit_idx++;
-
-        // if (bit_idx == 8) {
-        //      buf[buf_idx] = 0;
-        //     bit_idx = 0;
-        //     buf_idx++;
-        // }
-
-        // if (buf_idx > 0x2c) {
-        //     break;
-        // }
-
-        // // dump
-        // for (size_t i = 0; i < (size_t)SUBUCOM_BUFSIZE_LED; i++) {
-        //     printf("%02x ", buf[i]);
-        // }
-        // printf("\n");
-
-
-        // getchar();
-        
+    if (led_timeline_start(&timeline) < 0) {
+        exit(-1);
+    }
+    subucom_write_frame(&subucom, timeline.frames[0]);
 
-        buf_idx++;
-        usleep(500000);
+    loop = 1;
+    while (loop) {
+        /* sleeps on the timer, only frames that differ get written */
+        const uint8_t* frame = led_timeline_advance(&timeline);
+        if (frame != NULL) {
+            subucom_write_frame(&subucom, frame);
+        }
     }
 
     signal(SIGINT, SIG_DFL);
 
+    led_timeline_free(&timeline);
     subucom_deinit(&subucom);
 
     return 0;
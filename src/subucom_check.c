@@ -11,10 +11,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "lib/subucom.h"
 
+#define SCAN_TIME_MS            2
+#define SAMPLE_WINDOW_MS        50
+#define DEADLINE_MS             100
+#define STABLE_FRAMES           5
+
+/* TRACK_FWD and LOOP_IN, nothing else held in their bytes (5 and 7) */
+#define MAGIC_COMBO (SUBUCOM_BUTTON(TRACK_FWD) | SUBUCOM_BUTTON(LOOP_IN))
+#define MAGIC_COMBO_BYTES \
+    ((0xFFull << ((SUBUCOM_IN_TRACK_FWD_BYTE - SUBUCOM_IN_PLAY_BYTE) * 8)) | \
+     (0xFFull << ((SUBUCOM_IN_LOOP_IN_BYTE - SUBUCOM_IN_PLAY_BYTE) * 8)))
+
 static void write_magic_file()
 {
     FILE *fp = fopen("/tmp/testmode", "w");
@@ -25,13 +37,88 @@ static void write_magic_file()
     }
 }
 
+static int64_t monotonic_millis() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Sample frames for window_ms, and never longer than deadline_ms in total.
+ * The combo counts as held if it matched stable_frames frames in a row, or
+ * in the majority of the valid frames seen in the window.
+ */
+static bool sample_combo(subucom_t* subucom, int window_ms, int deadline_ms, int stable_frames) {
+    int64_t start = monotonic_millis();
+    int64_t window_end = start + window_ms;
+    int64_t deadline = start + deadline_ms;
+    int valid = 0, matching = 0, run = 0;
+
+    if (window_end > deadline) {
+        window_end = deadline;
+    }
+
+    subucom_start_timer(subucom, SCAN_TIME_MS);
+
+    int64_t now;
+    while ((now = monotonic_millis()) < window_end) {
+        int ret = subucom_read_timeout(subucom, (int)(window_end - now));
+        if (ret == SUBUCOM_ERR_CRC || ret == 0) {
+            continue;
+        }
+        if (ret < 0) {
+            break;
+        }
+
+        valid++;
+        uint64_t buttons = subucom_get_state(subucom, SUBUCOM_STATE_BUTTONS)->buttons;
+        if ((buttons & MAGIC_COMBO_BYTES) == MAGIC_COMBO) {
+            matching++;
+            if (++run >= stable_frames) {
+                break;
+            }
+        } else {
+            run = 0;
+        }
+    }
+
+    subucom_stop_timer(subucom);
+
+    PRINT("subucom_check: %d of %d frames matched in %lld ms\n", matching, valid,
+          (long long)(monotonic_millis() - start));
+
+    return (run >= stable_frames) || (valid > 0 && matching * 2 > valid);
+}
+
 int main(int argc, char *argv[]) {
     subucom_t subucom;
     int ret;
 
+    int window_ms = SAMPLE_WINDOW_MS;
+    int deadline_ms = DEADLINE_MS;
+    int stable_frames = STABLE_FRAMES;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:w:")) != -1) {
+        switch (opt) {
+        case 'd':
+            deadline_ms = atoi(optarg);
+            break;
+        case 'n':
+            stable_frames = atoi(optarg);
+            break;
+        case 'w':
+            window_ms = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-w window_ms] [-d deadline_ms] [-n stable_frames] [device]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
     char *device_path = NULL;
-    if (argc == 2) {
-        device_path = argv[1];
+    if (optind < argc) {
+        device_path = argv[optind];
     }
 
     ret = subucom_init(&subucom, device_path);
@@ -39,19 +126,13 @@ int main(int argc, char *argv[]) {
         exit(-1);
     }
 
-    int bytes_read = subucom_read(&subucom);
-    uint8_t* buf = subucom._buf;
-
-    if (bytes_read > 0) {
-        /* check for TRACK_FWD and LOOP_IN */
-        if (buf[5] == 0x10 && buf[7] == 0x01) { 
-            printf("subucom_check: magic key combo detected!\n");
-            write_magic_file();
-            return 1;
-        }
+    int detected = sample_combo(&subucom, window_ms, deadline_ms, stable_frames);
+    if (detected) {
+        printf("subucom_check: magic key combo detected!\n");
+        write_magic_file();
     }
 
     subucom_deinit(&subucom);
 
-    return 0;
+    return detected ? 1 : 0;
 }
@@ -2,7 +2,7 @@
 /*
  *  CDJ3K utility program that reads subucom controller state and dumps to the
  *  screen continously.
- * 
+ *
  *  This file is part of the Magic Phono project (https://magicphono.org/).
  *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
  */
@@ -13,12 +13,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <time.h>
 
 #include "lib/crc16.h"
+#include "lib/shm_state.h"
 #include "lib/subucom.h"
 
 
 #define SCAN_TIME_MS            50
+#define HEADLESS_SCAN_TIME_MS   2
+
+#define HEX_ROW                 2
+#define STATUS_COL              (SUBUCOM_BUFSIZE * 3 + 1)
+#define FIELDS_ROW              4
+#define FIELD_WIDTH             24
+#define FIELDS_PER_ROW          8
 
 enum colors {
     COLOR_CHANGE = 1,
@@ -27,20 +36,314 @@ enum colors {
     COLOR_FAIL = 4
 };
 
+enum output_mode {
+    OUTPUT_SCREEN,
+    OUTPUT_CSV,
+    OUTPUT_BINARY
+};
+
+/* decoded input fields, see doc/subucom_fields.js */
+typedef struct field {
+    const char *name;
+    uint8_t byte;
+    uint8_t mask;       /* single byte fields */
+    uint8_t bytes;      /* 2 for big endian 16-bit fields */
+} field_t;
+
+#define FIELD(label, name) \
+    { label, SUBUCOM_IN_##name##_BYTE, (uint8_t)SUBUCOM_IN_##name##_MASK, (SUBUCOM_IN_##name##_WIDTH + 7) / 8 }
+
+static const field_t fields[] = {
+    FIELD("MAJOR_REV",    MAJOR_REVISION),
+    FIELD("MINOR_REV",    MINOR_REVISION),
+    FIELD("SLIP_PADDLE",  SLIP_PADDLE),
+    FIELD("PLAY",         PLAY),
+    FIELD("CUE",          CUE),
+    FIELD("SEARCH_FWD",   SEARCH_FWD),
+    FIELD("SEARCH_REV",   SEARCH_REV),
+    FIELD("TRACK_FWD",    TRACK_FWD),
+    FIELD("TRACK_REV",    TRACK_REV),
+    FIELD("BEATJUMP_FWD", BEATJUMP_FWD),
+    FIELD("BEATJUMP_REV", BEATJUMP_REV),
+    FIELD("TEMPO_RESET",  TEMPO_RESET),
+    FIELD("TEMPO_MASTER", TEMPO_MASTER),
+    FIELD("TEMPO_RANGE",  TEMPO_RANGE),
+    FIELD("KEYSYNC",      KEYSYNC),
+    FIELD("BEATSYNC",     BEATSYNC),
+    FIELD("MASTER",       MASTER),
+    FIELD("LOOP_IN",      LOOP_IN),
+    FIELD("LOOP_OUT",     LOOP_OUT),
+    FIELD("RELOOP",       RELOOP),
+    FIELD("BEAT_LOOP_4",  BEAT_LOOP_4),
+    FIELD("BEAT_LOOP_8",  BEAT_LOOP_8),
+    FIELD("SLIP",         SLIP),
+    FIELD("MEMORY",       MEMORY),
+    FIELD("MEM_DELETE",   MEM_DELETE),
+    FIELD("MEM_CUE_FWD",  MEM_CUE_FWD),
+    FIELD("MEM_CUE_REV",  MEM_CUE_REV),
+    FIELD("CALL_DELETE",  CALL_DELETE),
+    FIELD("HOTCUE_A",     HOTCUE_A),
+    FIELD("HOTCUE_B",     HOTCUE_B),
+    FIELD("HOTCUE_C",     HOTCUE_C),
+    FIELD("HOTCUE_D",     HOTCUE_D),
+    FIELD("HOTCUE_E",     HOTCUE_E),
+    FIELD("HOTCUE_F",     HOTCUE_F),
+    FIELD("HOTCUE_G",     HOTCUE_G),
+    FIELD("HOTCUE_H",     HOTCUE_H),
+    FIELD("SOURCE",       SOURCE),
+    FIELD("BROWSE",       BROWSE),
+    FIELD("TAGLIST",      TAGLIST),
+    FIELD("PLAYLIST",     PLAYLIST),
+    FIELD("SEARCH",       SEARCH),
+    FIELD("MENU",         MENU),
+    FIELD("JOG_MODE",     JOG_MODE),
+    FIELD("BACK",         BACK),
+    FIELD("TAG_TRACK",    TAG_TRACK),
+    FIELD("TRACK_FILTER", TRACK_FILTER),
+    FIELD("SHORTCUT",     SHORTCUT),
+    FIELD("ROTARY_SEL",   ROTARY_SEL),
+    FIELD("TIME",         TIME),
+    FIELD("QUANTIZE",     QUANTIZE),
+    FIELD("SD",           SD),
+    FIELD("USB_STOP",     USB_STOP),
+    FIELD("ROTARY_POS",   ROTARY_ENCODER_POS),
+    FIELD("TOUCH_X",      TOUCHSCREEN_X),
+    FIELD("TOUCH_Y",      TOUCHSCREEN_Y),
+    FIELD("TEMPO_SLIDER", TEMPO_SLIDER_POS),
+    FIELD("VINYL_SPEED",  VINYL_SPEED_POS),
+    FIELD("JOG_POS",      JOG_POS),
+    FIELD("JOG_SPEED",    JOG_SPEED),
+    FIELD("JOG_PRESS",    JOG_PRESS),
+    FIELD("JOG_DIR",      JOG_DIR),
+    FIELD("JOG_MOVING",   JOG_MOVING),
+};
+#define NUM_FIELDS (sizeof(fields) / sizeof(fields[0]))
+
 int loop;
 void trap(int signal){ loop = 0; }
 
-int main(int argc, char *argv[]) {
-    subucom_t subucom;
-    uint8_t starting_buf[SUBUCOM_BUFSIZE] = {0};
+/* frames come from the device, or from the daemon's shared memory state */
+typedef struct source {
+    subucom_t*    subucom;      /* NULL when reading shared memory */
+    subucom_shm_t shm;
+    uint32_t      seq;
+    const uint8_t* buf;
+    int64_t       t_us;
+    subucom_shm_snapshot_t snapshot;
+} source_t;
+
+static int source_read(source_t* src) {
+    if (src->subucom != NULL) {
+        int ret = subucom_read(src->subucom);
+        /* a corrupt frame is shown as received */
+        src->buf = (ret == SUBUCOM_ERR_CRC) ? src->subucom->_rx_buf : src->subucom->_buf;
+        src->t_us = src->subucom->t_us;
+        return ret;
+    }
+
+    if (subucom_shm_wait(&src->shm, src->seq, 1000) != 0) {
+        return 0;
+    }
+
+    src->seq = subucom_shm_read(&src->shm, &src->snapshot);
+    src->buf = src->snapshot.frame;
+    src->t_us = src->snapshot.t_us;
+    return SUBUCOM_BUFSIZE;
+}
+
+static unsigned int field_value(const field_t* field, const uint8_t* buf) {
+    if (field->bytes == 2) {
+        return ((unsigned int)buf[field->byte] << 8) | buf[field->byte + 1];
+    }
+
+    unsigned int value = buf[field->byte] & field->mask;
+    /* single bit fields read as 0/1 */
+    if ((field->mask & (field->mask - 1)) == 0) {
+        value = value ? 1 : 0;
+    }
+    return value;
+}
+
+static int checksum_ok(const uint8_t* buf) {
+    uint16_t crc16 = crc16_x25_calc(buf, SUBUCOM_BUFSIZE-2);
+    uint8_t crch = (crc16 & 0xFF);
+    uint8_t crcl = (crc16 >> 8);
+    return (crch == buf[SUBUCOM_BUFSIZE-2] && crcl == buf[SUBUCOM_BUFSIZE-1]);
+}
+
+/*
+ * Screen state: what is currently drawn in every cell, so that a frame only
+ * touches the cells whose value or highlight changed.
+ */
+typedef struct screen {
+    int byte_val[SUBUCOM_BUFSIZE];
+    int byte_color[SUBUCOM_BUFSIZE];
+    int field_val[NUM_FIELDS];
+    int field_color[NUM_FIELDS];
+    int crc_ok;
+} screen_t;
+
+static void screen_init(screen_t* screen) {
+    for (size_t i = 0; i < SUBUCOM_BUFSIZE; i++) {
+        screen->byte_val[i] = -1;
+        screen->byte_color[i] = -1;
+    }
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        screen->field_val[i] = -1;
+        screen->field_color[i] = -1;
+    }
+    screen->crc_ok = -1;
+
+    for (size_t i = 0; i < SUBUCOM_BUFSIZE; i++) {
+        printw("%02x ", (unsigned char)i);
+    }
+    addstr("\n");
+    hline(ACS_HLINE, 191);
+}
+
+static void draw_cell(int row, int col, int color, const char* fmt, unsigned int value) {
+    if (color != 0) {
+        attron(COLOR_PAIR(color) | A_BOLD);
+    }
+    mvprintw(row, col, fmt, value);
+    if (color != 0) {
+        attroff(COLOR_PAIR(color) | A_BOLD);
+    }
+}
+
+static void screen_update(screen_t* screen, const uint8_t* buf, const uint8_t* prev_buf, const uint8_t* starting_buf) {
+    for (size_t i = 0; i < SUBUCOM_BUFSIZE; i++) {
+        int color = 0;
+        if (buf[i] != prev_buf[i]) {
+            color = COLOR_CHANGE;
+        } else if (buf[i] != starting_buf[i]) {
+            color = COLOR_ON;
+        }
+
+        if (buf[i] != screen->byte_val[i] || color != screen->byte_color[i]) {
+            draw_cell(HEX_ROW, i * 3, color, "%02x", buf[i]);
+            screen->byte_val[i] = buf[i];
+            screen->byte_color[i] = color;
+        }
+    }
+
+    int crc_ok = checksum_ok(buf);
+    if (crc_ok != screen->crc_ok) {
+        attron(COLOR_PAIR(crc_ok ? COLOR_OK : COLOR_FAIL) | A_BOLD);
+        mvprintw(HEX_ROW, STATUS_COL, "-- %-4s", crc_ok ? "OK" : "FAIL");
+        attroff(COLOR_PAIR(crc_ok ? COLOR_OK : COLOR_FAIL) | A_BOLD);
+        screen->crc_ok = crc_ok;
+    }
+
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        const field_t* field = &fields[i];
+        int value = field_value(field, buf);
+        int color = 0;
+        if (value != (int)field_value(field, prev_buf)) {
+            color = COLOR_CHANGE;
+        } else if (value != (int)field_value(field, starting_buf)) {
+            color = COLOR_ON;
+        }
+
+        if (value != screen->field_val[i] || color != screen->field_color[i]) {
+            int row = FIELDS_ROW + i / FIELDS_PER_ROW;
+            int col = (i % FIELDS_PER_ROW) * FIELD_WIDTH;
+            mvprintw(row, col, "%-13s", field->name);
+            draw_cell(row, col + 14, color, "%-5u", value);
+            screen->field_val[i] = value;
+            screen->field_color[i] = color;
+        }
+    }
+}
+
+/*
+ * Headless output, one record per frame that differs from the previous one.
+ *
+ * CSV:    t_us,seq,crc_ok,byte:value[ byte:value...]
+ * binary: struct frame_diff followed by count (byte, value) pairs
+ */
+typedef struct __attribute__((packed)) frame_diff {
+    int64_t  t_us;
+    uint32_t seq;
+    uint8_t  crc_ok;
+    uint8_t  count;
+} frame_diff_t;
+
+static void write_diff(enum output_mode mode, int64_t t_us, uint32_t seq, const uint8_t* buf, const uint8_t* prev_buf) {
+    uint8_t pairs[SUBUCOM_BUFSIZE * 2];
+    uint8_t count = 0;
+
+    for (size_t i = 0; i < SUBUCOM_BUFSIZE; i++) {
+        if (buf[i] != prev_buf[i]) {
+            pairs[count * 2] = i;
+            pairs[count * 2 + 1] = buf[i];
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    if (mode == OUTPUT_BINARY) {
+        frame_diff_t diff = { .t_us = t_us, .seq = seq, .crc_ok = checksum_ok(buf), .count = count };
+        fwrite(&diff, sizeof(diff), 1, stdout);
+        fwrite(pairs, 2, count, stdout);
+    } else {
+        printf("%lld,%u,%d,", (long long)t_us, seq, checksum_ok(buf));
+        for (int i = 0; i < count; i++) {
+            printf(i == 0 ? "%u:%02x" : " %u:%02x", pairs[i * 2], pairs[i * 2 + 1]);
+        }
+        putchar('\n');
+    }
+}
+
+static int run_headless(source_t* src, enum output_mode mode, int scan_time_ms) {
+    static char out_buf[1 << 16];
     uint8_t prev_buf[SUBUCOM_BUFSIZE] = {0};
-    int ret;
+    uint32_t seq = 0, late = 0, crc_fail = 0;
+    int64_t last_us = 0;
 
-    char *device_path = NULL;
-    if (argc == 2) {
-        device_path = argv[1];
+    /* keep the writes off the 2 ms path, a full buffer is one write() */
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+
+    if (mode == OUTPUT_CSV) {
+        printf("t_us,seq,crc_ok,changes\n");
+    }
+
+    while (loop) {
+        int bytes_read = source_read(src);
+        int64_t t_us = src->t_us;
+
+        if (bytes_read == SUBUCOM_ERR_CRC) {
+            crc_fail++;
+        } else if (bytes_read < 0) {
+            break;
+        } else if (bytes_read == 0) {
+            continue;
+        }
+
+        /* a gap of more than 1.5 ticks means at least one missed frame */
+        if (src->subucom != NULL && last_us != 0 && t_us - last_us > scan_time_ms * 1500) {
+            late++;
+        }
+        last_us = t_us;
+
+        write_diff(mode, t_us, seq++, src->buf, prev_buf);
+        memcpy(prev_buf, src->buf, SUBUCOM_BUFSIZE);
     }
 
+    fflush(stdout);
+    fprintf(stderr, "subucom_dump: %u frames, %u late, %u checksum failures\n", seq, late, crc_fail);
+
+    return 0;
+}
+
+static int run_screen(source_t* src) {
+    uint8_t starting_buf[SUBUCOM_BUFSIZE] = {0};
+    uint8_t prev_buf[SUBUCOM_BUFSIZE] = {0};
+    screen_t screen;
+
     initscr();
     start_color();
     init_pair(COLOR_CHANGE, COLOR_GREEN, COLOR_BLACK);
@@ -48,81 +351,120 @@ int main(int argc, char *argv[]) {
     init_pair(COLOR_OK, COLOR_CYAN, COLOR_BLACK);
     init_pair(COLOR_FAIL, COLOR_RED, COLOR_BLACK);
     noecho();
+    curs_set(0);
     clear();
-    
-    ret = subucom_init(&subucom, device_path);
-    if (ret != 0) {
-        exit(-1);
-    }
 
-    subucom_start_timer(&subucom, SCAN_TIME_MS);
+    screen_init(&screen);
 
-    for (size_t i = 0; i < SUBUCOM_BUFSIZE; i++) {
-        printw("%02x ", (unsigned char)i);
+    /* the device is closed after a read error, stop rather than spin */
+    int ret = 0;
+    while (loop && (ret = source_read(src)) <= 0) {
+        if (ret < 0 && ret != SUBUCOM_ERR_CRC) {
+            loop = 0;
+        }
     }
-    addstr("\n");
-    hline(ACS_HLINE, 191);
-
-    signal(SIGINT, &trap);
+    if (loop && src->subucom != NULL) {
+        ret = source_read(src);
+        if (ret < 0 && ret != SUBUCOM_ERR_CRC) {
+            loop = 0;
+        }
+    }
+    memcpy(starting_buf, src->buf, SUBUCOM_BUFSIZE);
+    memcpy(prev_buf, src->buf, SUBUCOM_BUFSIZE);
 
-    subucom_read(&subucom);
-    subucom_read(&subucom);
-    memcpy(starting_buf, subucom._buf, SUBUCOM_BUFSIZE);
+    while (loop) {
+        int bytes_read = source_read(src);
 
-    loop = 1;
-    while (loop) {        
-        int bytes_read = subucom_read(&subucom);
-
-        move(2, 0);
-        clrtoeol(); 
-
-        uint8_t* buf = subucom._buf;
-
-        if (bytes_read > 0) {
-            uint16_t crc16 = crc16_x25_calc(buf, SUBUCOM_BUFSIZE-2);
-
-            for (size_t i = 0; i < (size_t)bytes_read; i++) {
-                if (buf[i] != prev_buf[i]) {
-                    attron(COLOR_PAIR(COLOR_CHANGE) | A_BOLD);
-                } else if (buf[i] != starting_buf[i]) {
-                    attron(COLOR_PAIR(COLOR_ON) | A_BOLD);
-                }
-                printw("%02x ", buf[i]);
-                attroff(COLOR_PAIR(COLOR_CHANGE) | COLOR_PAIR(COLOR_ON) | A_BOLD);
-            }
-
-            printw(" -- ");
-            uint8_t crch = (crc16 & 0xFF);
-            uint8_t crcl = (crc16 >> 8);
-            if (crch == buf[SUBUCOM_BUFSIZE-2] && crcl == buf[SUBUCOM_BUFSIZE-1]) {
-                attron(COLOR_PAIR(COLOR_OK) | A_BOLD);
-                printw("OK");
-                attroff(COLOR_PAIR(COLOR_OK) | A_BOLD);
-            } else {
-                attron(COLOR_PAIR(COLOR_FAIL) | A_BOLD);
-                printw("FAIL");
-                attroff(COLOR_PAIR(COLOR_FAIL) | A_BOLD);
-            }
-            
-            addstr("\n");
-        } else {
+        if (bytes_read == 0) {
+            continue;
+        } else if (bytes_read < 0 && bytes_read != SUBUCOM_ERR_CRC) {
             break;
         }
 
+        const uint8_t* buf = src->buf;
+        screen_update(&screen, buf, prev_buf, starting_buf);
         refresh();
-        memcpy(prev_buf, buf, SUBUCOM_BUFSIZE);
 
-        usleep(SCAN_TIME_MS * 1000);
+        memcpy(prev_buf, buf, SUBUCOM_BUFSIZE);
     }
 
-    signal(SIGINT, SIG_DFL);
-
     endwin();
 
-    subucom_stop_timer(&subucom);
-    subucom_deinit(&subucom);
-
     return 0;
 }
 
+int main(int argc, char *argv[]) {
+    subucom_t subucom;
+    enum output_mode mode = OUTPUT_SCREEN;
+    source_t src = { 0 };
+    bool use_shm = false;
+    int scan_time_ms = 0;
+    int ret;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "bcst:")) != -1) {
+        switch (opt) {
+        case 's':
+            /* read subucom_uinput's shared state instead of the device */
+            use_shm = true;
+            break;
+        case 'b':
+            mode = OUTPUT_BINARY;
+            break;
+        case 'c':
+            mode = OUTPUT_CSV;
+            break;
+        case 't':
+            scan_time_ms = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c | -b] [-s] [-t scan_ms] [device]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
+    if (scan_time_ms <= 0) {
+        scan_time_ms = (mode == OUTPUT_SCREEN) ? SCAN_TIME_MS : HEADLESS_SCAN_TIME_MS;
+    }
+
+    char *device_path = NULL;
+    if (optind < argc) {
+        device_path = argv[optind];
+    }
+
+    if (use_shm) {
+        ret = subucom_shm_open(&src.shm, NULL);
+    } else {
+        ret = subucom_init(&subucom, device_path);
+        src.subucom = &subucom;
+    }
+    if (ret != 0) {
+        exit(-1);
+    }
 
+    if (!use_shm) {
+        subucom_start_timer(&subucom, scan_time_ms);
+    }
+
+    signal(SIGINT, &trap);
+    signal(SIGTERM, &trap);
+
+    loop = 1;
+    if (mode == OUTPUT_SCREEN) {
+        run_screen(&src);
+    } else {
+        run_headless(&src, mode, scan_time_ms);
+    }
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    if (use_shm) {
+        subucom_shm_close(&src.shm);
+    } else {
+        subucom_stop_timer(&subucom);
+        subucom_deinit(&subucom);
+    }
+
+    return 0;
+}
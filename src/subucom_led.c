@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K utility program to set LEDs through subucom_uinput.
+ * 
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lib/led_server.h"
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-s socket] LED=level ...\n", name);
+    fprintf(stderr, "LEDs:");
+    for (int i = 0; i < NUM_LEDS; i++) {
+        fprintf(stderr, " %s", led_defs[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(-1);
+}
+
+int main(int argc, char *argv[]) {
+    const char *socket_path = LED_SERVER_PATH;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        switch (opt) {
+        case 's':
+            socket_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+
+    /* all pairs go out in one message, so they land in the same frame */
+    led_msg_t msg = { .type = LED_MSG_SET, .count = 0 };
+    for (int i = optind; i < argc && msg.count < NUM_LEDS; i++) {
+        char name[32];
+        unsigned int level;
+        if (sscanf(argv[i], "%31[^=]=%i", name, &level) != 2) {
+            usage(argv[0]);
+        }
+
+        int led = led_find(name);
+        if (led < 0) {
+            fprintf(stderr, "subucom_led: Unknown LED %s\n", name);
+            exit(-1);
+        }
+
+        msg.pairs[msg.count].led = led;
+        msg.pairs[msg.count].level = level;
+        msg.count++;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "subucom_led: Error connecting to %s: %s\n", socket_path, strerror(errno));
+        exit(-1);
+    }
+
+    size_t len = 2 + msg.count * sizeof(led_msg_pair_t);
+    if (send(fd, &msg, len, 0) != (ssize_t)len) {
+        fprintf(stderr, "subucom_led: Error sending: %s\n", strerror(errno));
+        close(fd);
+        exit(-1);
+    }
+
+    close(fd);
+    return 0;
+}
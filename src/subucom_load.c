@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom load generator
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+/*
+ * Feeds synthetic worst-case frames through the regular subucom_read() path
+ * to find how fast decoding and emitting can go. A child process generates
+ * frames at a fixed rate into a SOCK_SEQPACKET socket, which stands in for
+ * the device; its queue is kept a few frames deep, so frames the reader
+ * doesn't pick up in time are dropped like the driver would.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "lib/crc16.h"
+#include "lib/keymap.h"
+#include "lib/subucom.h"
+#include "lib/uinput.h"
+
+#define DEFAULT_RATE_HZ     500
+#define MAX_RATE_HZ         10000
+#define DEFAULT_SECONDS     10
+#define QUEUE_FRAMES        4
+
+#define PATTERN_BUTTONS     (1u << 0)   /* every button toggles each frame */
+#define PATTERN_JOG         (1u << 1)   /* jog spinning continuously */
+#define PATTERN_TOUCH       (1u << 2)   /* touchscreen drag */
+#define PATTERN_ROTARY      (1u << 3)   /* rotary turning each frame */
+
+static const struct {
+    const char* name;
+    uint32_t    bit;
+} pattern_names[] = {
+    { "buttons", PATTERN_BUTTONS },
+    { "jog",     PATTERN_JOG },
+    { "touch",   PATTERN_TOUCH },
+    { "rotary",  PATTERN_ROTARY },
+};
+
+/* generator counters, shared with the child */
+typedef struct gen_stats {
+    uint64_t sent;
+    uint64_t dropped;           /* queue full */
+    uint64_t corrupted;
+} gen_stats_t;
+
+int loop;
+void trap(int signal){ loop = 0; }
+
+static int64_t monotonic_micros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int parse_patterns(const char* arg, uint32_t* patterns) {
+    char buf[64];
+    strncpy(buf, arg, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    *patterns = 0;
+    char* save = NULL;
+    for (char* tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+        size_t i;
+        for (i = 0; i < sizeof(pattern_names) / sizeof(pattern_names[0]); i++) {
+            if (strcmp(pattern_names[i].name, tok) == 0) {
+                *patterns |= pattern_names[i].bit;
+                break;
+            }
+        }
+        if (i == sizeof(pattern_names) / sizeof(pattern_names[0])) {
+            fprintf(stderr, "subucom_load: Unknown pattern %s\n", tok);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void put_be16(uint8_t* frame, int byte, uint16_t value) {
+    frame[byte] = value >> 8;
+    frame[byte + 1] = value & 0xFF;
+}
+
+static void make_frame(uint8_t* frame, uint32_t n, uint32_t patterns) {
+    memset(frame, 0, SUBUCOM_BUFSIZE);
+    frame[SUBUCOM_IN_SLIP_PADDLE_BYTE] = 0x03;
+
+    if (patterns & PATTERN_BUTTONS) {
+        memset(frame + SUBUCOM_IN_PLAY_BYTE, (n & 1) ? 0xFF : 0x00, 8);
+    }
+    if (patterns & PATTERN_JOG) {
+        put_be16(frame, SUBUCOM_IN_JOG_POS_BYTE, n * 7);
+        put_be16(frame, SUBUCOM_IN_JOG_SPEED_BYTE, n * 3);
+        frame[SUBUCOM_IN_JOG_MOVING_BYTE] = SUBUCOM_IN_JOG_MOVING_MASK | SUBUCOM_IN_JOG_DIR_MASK;
+    }
+    if (patterns & PATTERN_TOUCH) {
+        put_be16(frame, SUBUCOM_IN_TOUCHSCREEN_X_BYTE, n % 1024);
+        put_be16(frame, SUBUCOM_IN_TOUCHSCREEN_Y_BYTE, (n / 2) % 600);
+    }
+    if (patterns & PATTERN_ROTARY) {
+        put_be16(frame, SUBUCOM_IN_ROTARY_ENCODER_POS_BYTE, n);
+    }
+
+    uint16_t crc = crc16_x25_calc(frame, SUBUCOM_BUFSIZE - 2);
+    frame[SUBUCOM_BUFSIZE - 2] = crc & 0xFF;
+    frame[SUBUCOM_BUFSIZE - 1] = crc >> 8;
+}
+
+/* child: send frames at rate_hz until the reader goes away */
+static void generate(int fd, int rate_hz, uint32_t patterns, int corrupt_pct, volatile gen_stats_t* stats) {
+    uint8_t frame[SUBUCOM_BUFSIZE];
+    uint8_t leds[SUBUCOM_BUFSIZE];
+    int64_t period_ns = 1000000000LL / rate_hz;
+    struct timespec next;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    srand(1);
+
+    for (uint32_t n = 0; ; n++) {
+        make_frame(frame, n, patterns);
+        if (corrupt_pct > 0 && rand() % 100 < corrupt_pct) {
+            frame[SUBUCOM_IN_PLAY_BYTE] ^= 0x5A;
+            stats->corrupted++;
+        }
+
+        if (send(fd, frame, SUBUCOM_BUFSIZE, MSG_DONTWAIT) == SUBUCOM_BUFSIZE) {
+            stats->sent++;
+        } else if (errno == EAGAIN) {
+            stats->dropped++;
+        } else {
+            break;
+        }
+
+        /* LED frames written by the reader are not looked at */
+        while (recv(fd, leds, sizeof(leds), MSG_DONTWAIT) > 0) { }
+
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    subucom_t subucom;
+    uinput_t uinput;
+    bool use_uinput = false;
+    int rate_hz = DEFAULT_RATE_HZ;
+    int seconds = DEFAULT_SECONDS;
+    int corrupt_pct = 0;
+    uint32_t patterns = PATTERN_BUTTONS | PATTERN_JOG | PATTERN_TOUCH | PATTERN_ROTARY;
+    char* keymap_path = NULL;
+
+    uint64_t events = 0;
+    int64_t emit_us = 0;
+
+    void fire_input_event(int type, int code, int val, int64_t t_us) {
+        events++;
+        if (use_uinput) {
+            int64_t start = monotonic_micros();
+            uinput_emit(&uinput, type, code, val, t_us);
+            emit_us += monotonic_micros() - start;
+        }
+    }
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:d:k:p:r:u")) != -1) {
+        switch (opt) {
+        case 'c':
+            /* percentage of frames sent with a bad CRC */
+            corrupt_pct = atoi(optarg);
+            break;
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        case 'k':
+            keymap_path = optarg;
+            break;
+        case 'p':
+            /* e.g. "buttons,jog" */
+            if (parse_patterns(optarg, &patterns) != 0) {
+                exit(-1);
+            }
+            break;
+        case 'r':
+            rate_hz = atoi(optarg);
+            break;
+        case 'u':
+            /* emit to a real uinput device instead of only counting */
+            use_uinput = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c corrupt_pct] [-d seconds] [-k keymap] [-p buttons,jog,touch,rotary] [-r rate_hz] [-u]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
+    if (rate_hz <= 0 || rate_hz > MAX_RATE_HZ || seconds <= 0) {
+        fprintf(stderr, "subucom_load: Rate must be 1-%d Hz and the duration positive\n", MAX_RATE_HZ);
+        exit(-1);
+    }
+
+    keymap_t* keymap = (keymap_path != NULL) ? keymap_load(keymap_path) : keymap_make();
+    if (keymap == NULL) {
+        exit(-1);
+    }
+
+    if (use_uinput) {
+        uinput.all_keys = false;
+        if (uinput_init(&uinput, keymap) != 0) {
+            exit(-1);
+        }
+    }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) != 0) {
+        perror("subucom_load: socketpair");
+        exit(-1);
+    }
+    int sndbuf = QUEUE_FRAMES * SUBUCOM_BUFSIZE;
+    setsockopt(sv[1], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    volatile gen_stats_t* stats = mmap(NULL, sizeof(gen_stats_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (stats == MAP_FAILED) {
+        perror("subucom_load: mmap");
+        exit(-1);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(sv[0]);
+        generate(sv[1], rate_hz, patterns, corrupt_pct, stats);
+        _exit(0);
+    }
+    close(sv[1]);
+
+    if (subucom_init_fd(&subucom, sv[0]) != 0) {
+        exit(-1);
+    }
+    subucom_register_keymap(&subucom, keymap, fire_input_event);
+    subucom_start_timer(&subucom, 1);
+
+    signal(SIGINT, &trap);
+    signal(SIGTERM, &trap);
+
+    printf("subucom_load: %d Hz for %d s\n", rate_hz, seconds);
+    printf("%6s %10s %10s %10s %8s %8s %10s %10s\n",
+           "time", "sent/s", "read/s", "events/s", "dropped", "crc", "us/frame", "emit us/ev");
+
+    uint64_t frames = 0, crc_errors = 0;
+    uint64_t last_sent = 0, last_frames = 0, last_events = 0;
+    int64_t busy_us = 0;
+    int64_t start = monotonic_micros();
+    int64_t report = start + 1000000;
+
+    loop = 1;
+    while (loop) {
+        int ret = subucom_read_timeout(&subucom, 100);
+        int64_t now = monotonic_micros();
+
+        if (ret == SUBUCOM_ERR_CRC) {
+            crc_errors++;
+        } else if (ret < 0) {
+            break;
+        } else if (ret > 0) {
+            /* from poll() returning to the last event emitted */
+            frames++;
+            busy_us += now - subucom.t_us;
+        }
+
+        if (now >= report) {
+            printf("%5llds %10llu %10llu %10llu %8llu %8llu %10.2f %10.2f\n",
+                   (long long)((now - start) / 1000000),
+                   (unsigned long long)(stats->sent - last_sent),
+                   (unsigned long long)(frames - last_frames),
+                   (unsigned long long)(events - last_events),
+                   (unsigned long long)stats->dropped,
+                   (unsigned long long)crc_errors,
+                   frames ? (double)busy_us / frames : 0.0,
+                   events ? (double)emit_us / events : 0.0);
+            fflush(stdout);
+            last_sent = stats->sent;
+            last_frames = frames;
+            last_events = events;
+            report += 1000000;
+
+            if (now - start >= (int64_t)seconds * 1000000) {
+                loop = 0;
+            }
+        }
+    }
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+
+    double elapsed = (monotonic_micros() - start) / 1e6;
+    printf("subucom_load: %llu frames sent, %llu read (%.0f/s), %llu events (%.0f/s), "
+           "%llu dropped, %llu of %llu corrupted frames rejected\n",
+           (unsigned long long)stats->sent, (unsigned long long)frames, frames / elapsed,
+           (unsigned long long)events, events / elapsed, (unsigned long long)stats->dropped,
+           (unsigned long long)crc_errors, (unsigned long long)stats->corrupted);
+
+    subucom_deinit(&subucom);
+    if (use_uinput) {
+        uinput_deinit(&uinput);
+    }
+    keymap_free(keymap);
+
+    return 0;
+}
@@ -13,39 +13,212 @@
 #include <errno.h>
 #include <string.h>
 #include <signal.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 #include "lib/uinput.h"
 #include "lib/subucom.h"
 #include "lib/keymap.h"
+#include "lib/scan_rate.h"
+#include "lib/shm_state.h"
+#include "lib/led_server.h"
+#include "lib/sink.h"
+#include "lib/trace.h"
 
 #include <linux/input.h>
 #include <linux/uinput.h>
 
 
 #define SCAN_TIME_MS            2
+#define SCAN_IDLE_TIME_MS       10000
+
+static const int scan_steps_ms[] = { SCAN_TIME_MS, 10, 50 };
 
 int loop;
 void trap(int signal){ loop = 0; }
 
+/* tell the init system that the input device is usable */
+static void notify_ready(int ready_fd, const char *pid_path) {
+    if (pid_path != NULL) {
+        FILE *fp = fopen(pid_path, "w");
+        if (fp != NULL) {
+            fprintf(fp, "%d\n", getpid());
+            fclose(fp);
+        } else {
+            fprintf(stderr, "subucom_uinput: Error writing %s: %s\n", pid_path, strerror(errno));
+        }
+    }
+
+    if (ready_fd >= 0) {
+        if (write(ready_fd, "\n", 1) != 1) {
+            fprintf(stderr, "subucom_uinput: Error notifying readiness: %s\n", strerror(errno));
+        }
+        close(ready_fd);
+    }
+}
+
+static int write_uinput(sink_t* sink, const sink_event_t* ev) {
+    if (uinput_emit((uinput_t *)sink->ctx, ev->type, ev->code, ev->value, ev->t_us) == 0) {
+        return 1;
+    }
+    return (errno == EAGAIN) ? 0 : -1;
+}
 
 int main(int argc, char *argv[]) {
     subucom_t subucom;
     uinput_t uinput;
+    sink_set_t sinks;
     int ret;
 
-    void fire_input_event(int type, int code, int val) {
-        uinput_emit(&uinput, type, code, val);    
+    void fire_input_event(int type, int code, int val, int64_t t_us) {
+        sink_set_emit(&sinks, type, code, val, t_us);
+    }
+
+    scan_rate_t scan_rate;
+    scan_rate_init(&scan_rate, scan_steps_ms, sizeof(scan_steps_ms) / sizeof(int), SCAN_IDLE_TIME_MS);
+
+    void reload_keymap(int fd, short revents, void* ctx) {
+        const char* path = (const char *)ctx;
+
+        if (!keymap_watch_changed(fd, path)) {
+            return;
+        }
+
+        keymap_t* new_keymap = keymap_load(path);
+        if (new_keymap == NULL) {
+            fprintf(stderr, "subucom_uinput: keeping current keymap\n");
+            return;
+        }
+
+        printf("subucom_uinput: reloaded keymap %s\n", path);
+        keymap_t* old_keymap = subucom._keymap;
+        subucom_swap_keymap(&subucom, new_keymap);
+        keymap_free(old_keymap);
+    }
+
+    void read_leds(int fd, short revents, void* ctx) {
+        struct input_event ev;
+        while (uinput_read(&uinput, &ev) == 1) {
+            if (ev.type == EV_LED) {
+                subucom_set_evdev_led(&subucom, ev.code, ev.value);
+            }
+        }
+    }
+
+    char *keymap_path = NULL;
+    char *shm_name = SUBUCOM_SHM_NAME;
+    char *led_path = LED_SERVER_PATH;
+    char *pid_path = NULL;
+    char *event_path = NULL;
+    char *midi_path = NULL;
+    sink_write_fn_t stream_write = NULL;
+    uint8_t debounce_frames[DEBOUNCE_NUM_CLASSES] = { 0 };
+    char *wear_dir = WEAR_DIR;
+    int ready_fd = -1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:e:i:k:l:m:M:n:o:p:r:tw:")) != -1) {
+        switch (opt) {
+        case 'b':
+            /* debounce frames per control class, e.g. "buttons=3,jog_press=2" */
+            if (debounce_parse(debounce_frames, optarg) != 0) {
+                exit(-1);
+            }
+            break;
+        case 'e':
+            /* event socket, e.g. SINK_SERVER_PATH */
+            event_path = optarg;
+            break;
+        case 'l':
+            /* LED control socket, "none" to disable */
+            led_path = (strcmp(optarg, "none") == 0) ? NULL : optarg;
+            break;
+        case 'm':
+            /* shared memory state name, "none" to disable */
+            shm_name = (strcmp(optarg, "none") == 0) ? NULL : optarg;
+            break;
+        case 'M':
+            /* MIDI FIFO or rawmidi port, "virmidi" for the ALSA virtual one */
+            midi_path = optarg;
+            break;
+        case 'n':
+            /* readiness fd, a newline is written to it once input is usable */
+            ready_fd = atoi(optarg);
+            break;
+        case 'o':
+            /* also stream events to stdout, status goes to stderr then */
+            if (strcmp(optarg, "json") == 0) {
+                stream_write = sink_write_json;
+            } else if (strcmp(optarg, "binary") == 0) {
+                stream_write = sink_write_binary;
+            } else {
+                fprintf(stderr, "subucom_uinput: Unknown output format %s\n", optarg);
+                exit(-1);
+            }
+            break;
+        case 'p':
+            /* pidfile, written once input is usable */
+            pid_path = optarg;
+            break;
+        case 'k':
+            /* keymap file, reloaded whenever it changes */
+            keymap_path = optarg;
+            break;
+        case 'i':
+            /* idle time before each step down, 0 keeps the fastest rate */
+            scan_rate.idle_ms = atoi(optarg);
+            break;
+        case 't':
+            /* mirror the tracepoints to the ftrace trace_marker */
+            if (subucom_trace_open() != 0) {
+                exit(-1);
+            }
+            break;
+        case 'w':
+            /* directory keeping the wear counters, "none" to disable */
+            wear_dir = (strcmp(optarg, "none") == 0) ? NULL : optarg;
+            break;
+        case 'r':
+            /* scan intervals in ms, fastest first, e.g. "2,10,50" */
+            if (scan_rate_parse_steps(&scan_rate, optarg) != 0) {
+                exit(-1);
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b class=frames,...] [-e event_socket] [-i idle_ms] [-k keymap] [-l led_socket] [-m shm_name] [-M midi_port] [-n ready_fd] [-o json|binary] [-p pidfile] [-r rate_ms,...] [-t] [-w wear_dir] [device]\n", argv[0]);
+            exit(-1);
+        }
     }
 
     char *device_path = NULL;
-    if (argc == 2) {
-        device_path = argv[1];
+    if (optind < argc) {
+        device_path = argv[optind];
+    }
+
+    int stream_fd = -1;
+    if (stream_write != NULL) {
+        stream_fd = sink_open_stream(STDOUT_FILENO);
+        if (stream_fd < 0) {
+            exit(-1);
+        }
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        signal(SIGPIPE, SIG_IGN);
     }
 
     printf("subucom_uinput: starting...\n");
 
-    keymap_t *keymap = keymap_make();
+    keymap_t *keymap;
+    if (keymap_path != NULL) {
+        keymap = keymap_load(keymap_path);
+    } else {
+        keymap = keymap_make();
+    }
+    if (keymap == NULL) {
+        exit(-1);
+    }
 
+    uinput.all_keys = (keymap_path != NULL);
     ret = uinput_init(&uinput, keymap);
     if (ret != 0) {
         exit(-1);
@@ -56,25 +229,146 @@ int main(int argc, char *argv[]) {
         exit(-1);
     }
 
+    /* each consumer has its own queue, a slow one never holds up the rest */
+    sink_set_init(&sinks, &subucom);
+    if (sink_add(&sinks, "uinput", uinput.fd, false, write_uinput, &uinput) == NULL) {
+        exit(-1);
+    }
+    if (stream_fd >= 0 && sink_add(&sinks, "stdout", stream_fd, true, stream_write, NULL) == NULL) {
+        close(stream_fd);
+    }
+
+    /* the [midi] section of the keymap says what goes out */
+    midi_out_t midi;
+    if (midi_path != NULL) {
+        if (midi_out_open(&midi, &subucom, midi_path) != 0) {
+            midi_path = NULL;
+        } else if (sink_add(&sinks, "midi", midi.fd, false, midi_sink_write, &midi) == NULL) {
+            midi_out_close(&midi);
+            midi_path = NULL;
+        }
+    }
+
+    sink_server_t sink_server;
+    if (event_path != NULL && sink_server_init(&sink_server, &sinks, event_path) != 0) {
+        event_path = NULL;
+    }
+
+    if (subucom_set_debounce(&subucom, debounce_frames) != 0) {
+        exit(-1);
+    }
     subucom_register_keymap(&subucom, keymap, fire_input_event);
 
-    subucom_start_timer(&subucom, SCAN_TIME_MS);
+    if (keymap_path != NULL) {
+        int watch_fd = keymap_watch_init(keymap_path);
+        if (watch_fd >= 0) {
+            subucom_watch_fd(&subucom, watch_fd, POLLIN, reload_keymap, keymap_path);
+        }
+    }
+
+    /* counters from earlier runs are carried on, a damaged file is left alone */
+    wear_counters_t wear;
+    char wear_path[256];
+    if (wear_dir != NULL) {
+        snprintf(wear_path, sizeof(wear_path), "%s/%s", wear_dir, WEAR_FILE);
+        if ((mkdir(wear_dir, 0755) != 0 && errno != EEXIST) || wear_load(&wear, wear_path) != 0) {
+            fprintf(stderr, "subucom_uinput: Not counting wear in %s\n", wear_dir);
+            wear_dir = NULL;
+        } else {
+            subucom_count_wear(&subucom, &wear);
+        }
+    }
+
+    subucom_shm_t shm = { 0 };
+    if (shm_name != NULL && subucom_shm_create(&shm, shm_name) != 0) {
+        shm.region = NULL;
+    }
+
+    /* EV_LED written by applications to the input device */
+    subucom_watch_fd(&subucom, uinput.fd, POLLIN, read_leds, NULL);
+
+    led_server_t led_server;
+    if (led_path != NULL && led_server_init(&led_server, &subucom, led_path) != 0) {
+        led_path = NULL;
+    }
+
+    scan_rate_start(&scan_rate, &subucom);
 
     signal(SIGINT, &trap);
+    signal(SIGTERM, &trap);
+
+    printf("subucom_uinput: ready on %s\n", uinput.devnode);
+    notify_ready(ready_fd, pid_path);
 
     loop = 1;
+    bool published = false;
+    int64_t wear_due_us = 0;
+    pid_t wear_pid = 0;
     while (loop) {
-        subucom_read(&subucom);
+        int bytes_read = subucom_read(&subucom);
+
+        /* other processes see every validated change */
+        if (shm.region != NULL && bytes_read > 0 && (subucom.frame_changed || !published)) {
+            subucom_shm_publish(&shm, subucom._buf, subucom.t_us);
+            published = true;
+        }
+
+        /* everything the frame produced leaves in one write */
+        if (midi_path != NULL && bytes_read > 0) {
+            midi_out_flush(&midi);
+        }
+
+        /* the disk write happens in a child, off the frame path */
+        if (wear_pid > 0 && waitpid(wear_pid, NULL, WNOHANG) == wear_pid) {
+            wear_pid = 0;
+        }
+        if (wear_dir != NULL && bytes_read > 0 && wear_pid <= 0 && subucom.t_us >= wear_due_us) {
+            wear_pid = wear_save_background(&wear, wear_path);
+            wear_due_us = subucom.t_us + WEAR_FLUSH_INTERVAL_S * 1000000LL;
+        }
+
+        scan_rate_update(&scan_rate, &subucom);
     }
 
     signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
 
     printf("subucom: tearing down...\n");
 
+    /* release everything still held before the device goes away */
+    keymap_t* last_keymap = subucom._keymap;
+    subucom_swap_keymap(&subucom, NULL);
+    sink_set_flush(&sinks, SINK_FLUSH_TIMEOUT_MS);
+    if (midi_path != NULL) {
+        midi_out_flush(&midi);
+    }
+
+    if (event_path != NULL) {
+        sink_server_deinit(&sink_server);
+    }
+    sink_set_deinit(&sinks);
+    if (midi_path != NULL) {
+        midi_out_close(&midi);
+    }
+    if (led_path != NULL) {
+        led_server_deinit(&led_server);
+    }
     subucom_stop_timer(&subucom);
     subucom_deinit(&subucom);
+    if (shm.region != NULL) {
+        subucom_shm_close(&shm);
+    }
+    if (wear_pid > 0) {
+        waitpid(wear_pid, NULL, 0);
+    }
+    if (wear_dir != NULL) {
+        wear_save(&wear, wear_path);
+    }
     uinput_deinit(&uinput);
-    keymap_free(keymap);
+    keymap_free(last_keymap);
+    if (pid_path != NULL) {
+        unlink(pid_path);
+    }
 
     return 0;
 }
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ *  CDJ3K subucom wear counter dump
+ *
+ *  This file is part of the Magic Phono project (https://magicphono.org/).
+ *  Copyright (c) 2025 xorbxbx <xorbxbx@magicphono.org>
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lib/wear.h"
+
+typedef struct button_name {
+    const char* name;
+    uint8_t     index;      /* into wear_counters_t.presses */
+} button_name_t;
+
+/* every 1 bit field in the button bytes */
+#define BUTTON_NAME(name, byte, shift, width) \
+    { #name, ((width) == 1 && (byte) >= SUBUCOM_IN_PLAY_BYTE && (byte) < SUBUCOM_IN_PLAY_BYTE + 8) \
+             ? ((byte) - SUBUCOM_IN_PLAY_BYTE) * 8 + (shift) : 0xFF },
+
+static const button_name_t buttons[] = {
+    SUBUCOM_IN_FIELDS(BUTTON_NAME)
+};
+
+static void print_time(const char* label, int64_t t) {
+    char buf[32];
+    time_t tt = (time_t)t;
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&tt));
+    printf("%-20s %s\n", label, buf);
+}
+
+int main(int argc, char *argv[]) {
+    bool all = false;
+    long ticks_per_rev = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "aj:")) != -1) {
+        switch (opt) {
+        case 'a':
+            /* include controls never pressed */
+            all = true;
+            break;
+        case 'j':
+            /* JOG_POS counts per jog revolution, as measured on the unit */
+            ticks_per_rev = atol(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-a] [-j ticks_per_rev] [file]\n", argv[0]);
+            exit(-1);
+        }
+    }
+
+    const char* path = (optind < argc) ? argv[optind] : WEAR_DIR "/" WEAR_FILE;
+
+    if (access(path, R_OK) != 0) {
+        fprintf(stderr, "subucom_wear: No wear counters at %s\n", path);
+        exit(-1);
+    }
+
+    wear_counters_t wear;
+    if (wear_load(&wear, path) != 0) {
+        exit(-1);
+    }
+
+    print_time("counting since", wear.since);
+    print_time("last saved", wear.saved);
+    printf("\n");
+
+    for (size_t i = 0; i < sizeof(buttons) / sizeof(buttons[0]); i++) {
+        if (buttons[i].index == 0xFF) {
+            continue;
+        }
+        uint64_t count = wear.presses[buttons[i].index];
+        if (count > 0 || all) {
+            printf("%-20s %llu\n", buttons[i].name, (unsigned long long)count);
+        }
+    }
+
+    printf("%-20s %llu\n", "JOG_PRESS", (unsigned long long)wear.jog_presses);
+    printf("%-20s %llu\n", "SLIP_PADDLE moves", (unsigned long long)wear.slip_paddle_moves);
+    printf("%-20s %llu\n", "ROTARY detents", (unsigned long long)wear.rotary_detents);
+    if (ticks_per_rev > 0) {
+        printf("%-20s %llu (%.1f revolutions)\n", "JOG ticks", (unsigned long long)wear.jog_ticks,
+               (double)wear.jog_ticks / ticks_per_rev);
+    } else {
+        printf("%-20s %llu\n", "JOG ticks", (unsigned long long)wear.jog_ticks);
+    }
+
+    return 0;
+}